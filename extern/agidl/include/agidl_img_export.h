@@ -15,4 +15,6 @@
 #include <agidl_img_types.h>
 #include <agidl_cc_types.h>
 
-void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGIDL_IMG_TYPE img_type);
\ No newline at end of file
+void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGIDL_IMG_TYPE img_type);
+u32 AGIDL_ReserveQuickExport();
+void AGIDL_QuickExportNumbered(void* data, u32 number, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGIDL_IMG_TYPE img_type);
\ No newline at end of file
@@ -15,15 +15,21 @@
 #include <agidl_img_export.h>
 #include <agidl_img_converter.h>
 
-u32 expcount = 0;
+static u32 expcount = 0;
 
 void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGIDL_IMG_TYPE img_type){
-	expcount++;
-	
+	AGIDL_QuickExportNumbered(data,AGIDL_ReserveQuickExport(),width,height,fmt,img_type);
+}
+
+u32 AGIDL_ReserveQuickExport(){
+	return ++expcount;
+}
+
+void AGIDL_QuickExportNumbered(void* data, u32 number, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGIDL_IMG_TYPE img_type){
 	switch(img_type){
 		case AGIDL_IMG_BMP:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.bmp",expcount);
+			sprintf(filename,"quick_export_%ld.bmp",number);
 			
 			AGIDL_BMP* bmp = AGIDL_CreateBMP(filename,width,height,fmt);
 			
@@ -41,7 +47,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_TGA:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.tga",expcount);
+			sprintf(filename,"quick_export_%ld.tga",number);
 			
 			AGIDL_TGA* tga = AGIDL_CreateTGA(filename,width,height,fmt);
 			
@@ -59,7 +65,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_TIM:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.tim",expcount);
+			sprintf(filename,"quick_export_%ld.tim",number);
 			
 			AGIDL_TIM* tim = AGIDL_CreateTIM(filename,width,height,fmt);
 			
@@ -77,7 +83,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_PCX:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.pcx",expcount);
+			sprintf(filename,"quick_export_%ld.pcx",number);
 			
 			AGIDL_PCX* pcx = AGIDL_CreatePCX(filename,width,height,fmt);
 			
@@ -95,7 +101,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_LMP:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.lmp",expcount);
+			sprintf(filename,"quick_export_%ld.lmp",number);
 			
 			AGIDL_LMP* lmp = AGIDL_CreateLMP(filename,width,height,fmt);
 			
@@ -113,7 +119,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_PVR:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.pvr",expcount);
+			sprintf(filename,"quick_export_%ld.pvr",number);
 			
 			AGIDL_PVR* pvr = AGIDL_CreatePVR(filename,width,height,fmt);
 			
@@ -131,7 +137,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_GXT:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.gxt",expcount);
+			sprintf(filename,"quick_export_%ld.gxt",number);
 			
 			AGIDL_GXT* gxt = AGIDL_CreateGXT(filename,width,height,fmt);
 			
@@ -149,7 +155,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_BTI:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.bti",expcount);
+			sprintf(filename,"quick_export_%ld.bti",number);
 			
 			AGIDL_BTI* bti = AGIDL_CreateBTI(filename,width,height,fmt);
 			
@@ -167,7 +173,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_3DF:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.glide",expcount);
+			sprintf(filename,"quick_export_%ld.glide",number);
 			
 			AGIDL_3DF* glide = AGIDL_Create3DF(filename,width,height,fmt);
 			
@@ -185,7 +191,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_PPM:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.ppm",expcount);
+			sprintf(filename,"quick_export_%ld.ppm",number);
 			
 			AGIDL_PPM* ppm = AGIDL_CreatePPM(filename,width,height,fmt);
 			
@@ -203,7 +209,7 @@ void AGIDL_QuickExport(void* data, u32 width, u32 height, AGIDL_CLR_FMT fmt, AGI
 		}break;
 		case AGIDL_IMG_LBM:{
 			char filename[50];
-			sprintf(filename,"quick_export_%ld.lbm",expcount);
+			sprintf(filename,"quick_export_%ld.lbm",number);
 			
 			AGIDL_LBM* lbm = AGIDL_CreateLBM(filename,width,height,fmt);
 			
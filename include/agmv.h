@@ -20,5 +20,10 @@
 #include <agmv_decode.h>
 #include <agmv_utils.h>
 #include <agmv_playback.h>
+#include <agmv_mapped.h>
+#include <agmv_thread.h>
+#include <agmv_simd.h>
+#include <agmv_player.h>
+#include <agmv_export.h>
 
 #endif
\ No newline at end of file
@@ -19,10 +19,32 @@
 #include <stdio.h>
 
 int AGMV_DecodeHeader(FILE* file, AGMV* agmv);
+void AGMV_DecodeIndexPointer(FILE* file, AGMV* agmv);
+int AGMV_ReadFrameChunk(FILE* file, AGMV* agmv, u32* csize);
 int AGMV_DecodeFrameChunk(FILE* file, AGMV* agmv);
+int AGMV_DecodeFramePayload(AGMV* agmv, const u8* payload, u32 csize);
+u32 AGMV_DecompressFrame(AGMV* agmv, const u8* payload, u32 csize);
+Bool AGMV_RenderFrame(AGMV* agmv, const u8* bitstream_data, u32 bpos, u8* dest, u32 stride, u32 bpp, const u32* palette0, const u32* palette1, const u8* iframe, u32 iframe_stride);
+Bool AGMV_IsFrameComplete(AGMV* agmv, const u8* bitstream_data, u32 bpos);
+u32 AGMV_DecompressLZSS(const u8* src, u32 csize, u8* dest, u32 usize, u32 capacity);
+u32 AGMV_DecompressLZ77(const u8* src, u32 csize, u8* dest, u32 capacity);
+AGMV_CANVAS* AGMV_CreateCanvas(AGMV* agmv, AGMV_PIXEL_FMT fmt);
+void AGMV_SyncCanvasPalette(AGMV_CANVAS* canvas, AGMV* agmv);
+void AGMV_DestroyCanvas(AGMV_CANVAS* canvas);
+AGMV_PIXEL_FMT AGMV_GetIndexFormat(AGMV* agmv);
+u32 AGMV_GetPaletteLUT(AGMV* agmv, AGMV_PIXEL_FMT fmt, u32* lut);
+int AGMV_DecodeFrameChunkToCanvas(FILE* file, AGMV* agmv, AGMV_CANVAS* canvas, void* pixels, u32 stride);
+int AGMV_DecodeFramePayloadToCanvas(AGMV* agmv, AGMV_CANVAS* canvas, const u8* payload, u32 csize, void* pixels, u32 stride);
+int AGMV_DecodeFrameChunkPreview(FILE* file, AGMV* agmv, u32* preview);
+int AGMV_DecodeFramePayloadPreview(AGMV* agmv, const u8* payload, u32 csize, u32* preview);
 int AGMV_DecodeAudioChunk(FILE* file, AGMV* agmv);
+int AGMV_DecodeAudioPayload(AGMV* agmv, const u8* payload, u32 size);
+int AGMV_DecodeAudioChunkToRing(FILE* file, AGMV* agmv, AGMV_AUDIO_RING* ring, u32* num_of_samples);
+int AGMV_DecodeAudioPayloadToRing(AGMV* agmv, const u8* payload, u32 size, AGMV_AUDIO_RING* ring, u32* num_of_samples);
 int AGMV_DecodeVideo(const char* filename, u8 img_type);
+int AGMV_DecodeVideoThreads(const char* filename, u8 img_type, u32 num_of_threads);
 int AGMV_DecodeAudio(const char* filename, AGMV_AUDIO_TYPE audio_type);
 int AGMV_DecodeAGMV(const char* filename, u8 img_type, AGMV_AUDIO_TYPE audio_type);
+int AGMV_DecodeAGMVThreads(const char* filename, u8 img_type, AGMV_AUDIO_TYPE audio_type, u32 num_of_threads);
 
 #endif
\ No newline at end of file
@@ -15,6 +15,8 @@
 *
 ********************************************/
 
+#include <stdio.h>
+
 /*---------AGMV FUNDAMENTAL DATA TYPES-------*/
 
 typedef unsigned char   u8;
@@ -39,12 +41,14 @@ typedef enum Error{
 	INVALID_HEADER_FORMATTING_ERR = 0x1,
 	FILE_NOT_FOUND_ERR = 0x2,
 	MEMORY_CORRUPTION_ERR = 0x3,
+	BUFFER_FULL_ERR = 0x4,
 }Error;
 
 /*-----------AGMV DATA STRUCTURES-----------*/
 
 #define AGMV_MAX_CLR     524287
-#define MAX_OFFSET_TABLE 40000
+#define AGMV_DEFAULT_MATCH_DEPTH 256
+#define AGMV_DEFAULT_LZ77_PARSE  AGMV_PARSE_OPTIMAL
 
 #define AGMV_FILL_FLAG    0x4E
 #define AGMV_NORMAL_FLAG  0x2f
@@ -52,6 +56,11 @@ typedef enum Error{
 #define AGMV_FILL_COUNT     14
 #define AGMV_COPY_COUNT     13
 
+#define AGMV_INDEX_IFRAME   0x1
+#define AGMV_INDEX_CLEAN    0x2  /* THE I-FRAME DRAWS EVERY BLOCK, SO DECODING CAN START FROM IT ALONE */
+#define AGMV_INDEX_CHECKED  0x4  /* AGMV_INDEX_CLEAN IS KNOWN FOR THIS I-FRAME. OLDER ENCODERS LEAVE BOTH BITS CLEAR */
+#define AGMV_INDEX_ENTRY_SIZE 9
+
 /* AGMV OPTIMIZATION FLAGS */
 typedef enum AGMV_OPT{
 	AGMV_OPT_I       = 0x1,  /* 512 COLORS, BITSTREAM V1, HEAVY PDIFS */
@@ -75,6 +84,23 @@ typedef enum AGMV_COMPRESSION{
 	AGMV_LZ77_COMPRESSION = 0x2,
 }AGMV_COMPRESSION;
 
+/* HOW AGMV_LZ77 CHOOSES BETWEEN THE MATCHES ITS MATCH FINDER RETURNS */
+typedef enum AGMV_LZ_PARSE{
+	AGMV_PARSE_GREEDY  = 0x1,
+	AGMV_PARSE_OPTIMAL = 0x2,
+}AGMV_LZ_PARSE;
+
+/* PIXEL FORMATS FOR DECODING STRAIGHT INTO A CALLER FRAMEBUFFER, GIVEN AS THE VALUE OF ONE PIXEL */
+typedef enum AGMV_PIXEL_FMT{
+	AGMV_PIXEL_XRGB8888 = 0x1,  /* 0x00RRGGBB, SAME AS agmv->frame->img_data */
+	AGMV_PIXEL_BGRA8888 = 0x2,  /* 0xBBGGRRAA, ALPHA ALWAYS 0xFF */
+	AGMV_PIXEL_RGB565   = 0x3,  /* RRRRRGGGGGGBBBBB */
+	AGMV_PIXEL_RGB555   = 0x4,  /* 0RRRRRGGGGGBBBBB */
+	AGMV_PIXEL_BGR555   = 0x5,  /* 0BBBBBGGGGGRRRRR, NATIVE GBA/NDS ORDER */
+	AGMV_PIXEL_INDEX8   = 0x6,  /* PALETTE INDEX, FOR ONE PALETTE FILES (V2/V4) */
+	AGMV_PIXEL_INDEX16  = 0x7,  /* PALETTE NUMBER << 8 | INDEX, FOR TWO PALETTE FILES (V1/V3) */
+}AGMV_PIXEL_FMT;
+
 typedef struct AGMV_MAIN_HEADER{
 	char fourcc[4]; /* AGMV IN PLAIN ASCII */
 	u32 num_of_frames;
@@ -90,6 +116,7 @@ typedef struct AGMV_MAIN_HEADER{
 	u16 bits_per_sample;
 	u32 palette0[256];
 	u32 palette1[256];
+	u32 index_offset; /* OFFSET OF AGIC CHUNK FROM AGIP POINTER, 0 IF NO INDEX */
 }AGMV_MAIN_HEADER;
 
 typedef struct AGMV_FRAME_CHUNK{
@@ -112,6 +139,13 @@ typedef struct AGMV_FRAME{
 	u32* img_data;
 }AGMV_FRAME;
 
+typedef struct AGMV_RECT{
+	u32 x;
+	u32 y;
+	u32 width;
+	u32 height;
+}AGMV_RECT;
+
 typedef struct AGMV_AUDIO_TRACK{
 	u32 total_audio_duration;
 	u32 start_point;
@@ -119,6 +153,16 @@ typedef struct AGMV_AUDIO_TRACK{
 	u8* pcm8;
 }AGMV_AUDIO_TRACK;
 
+/* CALLER OWNED RING OF DECODED SAMPLES FOR STREAMING AUDIO ONE AGAC CHUNK AT A TIME. HEAD AND TAIL ARE FREE RUNNING SAMPLE
+   COUNTERS, SO ONE THREAD MAY DECODE INTO THE RING WHILE ANOTHER(E.G. AN AUDIO CALLBACK) READS FROM IT */
+typedef struct AGMV_AUDIO_RING{
+	u8* data;
+	u32 capacity;        /* IN SAMPLES */
+	u16 bits_per_sample; /* 8 OR 16 */
+	volatile u32 head;   /* SAMPLES DECODED INTO THE RING */
+	volatile u32 tail;   /* SAMPLES READ BACK OUT */
+}AGMV_AUDIO_RING;
+
 typedef struct AGMV_ENTRY{
 	u8 pal_num;
 	u8 index;
@@ -141,26 +185,196 @@ typedef struct AGMV_BITSTREAM{
 	u8* data;
 	u32 len;
 	u32 pos;
+	u32 bitbuf;
+	u32 bitsin;
 }AGMV_BITSTREAM;
 
+typedef struct AGMV_INDEX_ENTRY{
+	u32 frame_offset;
+	u32 audio_offset; /* 0 IF THE FRAME HAS NO AUDIO CHUNK */
+	u8 flags;
+}AGMV_INDEX_ENTRY;
+
+typedef struct AGMV_INDEX{
+	AGMV_INDEX_ENTRY* entries;
+	u32 len;
+	u32 size;
+	Bool loaded; /* TRUE ONCE THE ENCODER WRITTEN AGIC CHUNK HAS BEEN READ */
+}AGMV_INDEX;
+
+typedef struct AGMV_CANVAS{
+	AGMV_PIXEL_FMT fmt;
+	u32 bpp;     /* BYTES PER PIXEL OF fmt */
+	u32 width;
+	u32 height;
+	u32 palette0[256]; /* HEADER PALETTES PRE-CONVERTED TO fmt */
+	u32 palette1[256];
+	u8* iframe;  /* LAST I-FRAME IN fmt, width*bpp BYTES PER ROW */
+}AGMV_CANVAS;
+
+typedef struct AGMV_MAPPED_FILE{
+	u32 len;
+	u32 pos;
+	const u8* data;
+	void* handle;   /* PLATFORM FILE HANDLE, WIN32 ONLY */
+	void* mapping;  /* PLATFORM MAPPING HANDLE, WIN32 ONLY */
+	Bool mapped;    /* FALSE WHEN THE FILE WAS READ INTO A HEAP BUFFER */
+}AGMV_MAPPED_FILE;
+
+typedef enum AGMV_SIMD{
+	AGMV_SIMD_NONE = 0x0,
+	AGMV_SIMD_SSE2 = 0x1,
+	AGMV_SIMD_AVX2 = 0x2,
+	AGMV_SIMD_NEON = 0x3,
+}AGMV_SIMD;
+
+/* 4X4 BLOCK WRITERS FOR THE RENDERER, BPP IS 1, 2, 4 OR SIZEOF(U32) BYTES PER PIXEL. THE GATHER LUT HOLDS 256 PIXELS
+   OF BPP BYTES EACH, PLUS AT LEAST 8 BYTES OF PADDING */
+typedef struct AGMV_BLOCK_KERNELS{
+	void (*fill)(u8* dest, u32 stride, u32 bpp, u32 color);
+	void (*copy)(u8* dest, u32 stride, const u8* src, u32 src_stride, u32 bpp);
+	void (*gather)(u8* dest, u32 stride, u32 bpp, const u8* indices, const u8* lut);
+	Bool (*escapes)(const u8* indices); /* TRUE IF ANY OF THE 16 INDICES IS A TWO PALETTE ESCAPE(LOW 7 BITS ALL SET) */
+}AGMV_BLOCK_KERNELS;
+
+/* OPAQUE PLATFORM HANDLES, WIN32 THREADS ON WINDOWS AND PTHREADS EVERYWHERE ELSE */
+typedef void* AGMV_THREAD;
+typedef void* AGMV_MUTEX;
+typedef void* AGMV_COND;
+
+typedef void (*AGMV_THREAD_FUNC)(void* data);
+typedef void (*AGMV_TASK)(void* data, u32 index);
+
+/* BOUNDED SINGLE PRODUCER, SINGLE CONSUMER RING. HEAD AND TAIL ARE FREE RUNNING COUNTERS UPDATED WITH ATOMIC LOADS AND STORES.
+   THE MUTEX IS ONLY TAKEN BY A SIDE GOING TO SLEEP ON A FULL OR EMPTY RING, AND BY THE OTHER SIDE WHEN WAITERS SAYS ONE IS ASLEEP */
+typedef struct AGMV_RING{
+	void** slots;
+	u32 capacity;
+	volatile u32 head; /* SLOTS PUBLISHED BY THE PRODUCER */
+	volatile u32 tail; /* SLOTS RELEASED BY THE CONSUMER */
+	volatile u32 closed;
+	volatile u32 waiters; /* THREADS SLEEPING ON COND, ONLY CHANGED UNDER LOCK */
+	AGMV_MUTEX lock;
+	AGMV_COND cond;
+}AGMV_RING;
+
+typedef struct AGMV_THREAD_POOL{
+	AGMV_THREAD* threads;
+	u32 num_of_threads; /* WORKER THREADS PLUS THE CALLING THREAD */
+	AGMV_MUTEX lock;
+	AGMV_COND wake;
+	AGMV_COND done;
+	AGMV_TASK task;
+	void* data;
+	u32 count;
+	u32 next;
+	u32 finished;
+	Bool quit;
+}AGMV_THREAD_POOL;
+
+/* A FRAME QUEUED BY AGMV_EncodeFrame WHILE MULTITHREADED ENCODING IS ENABLED. AUDIO HOLDS ANY AUDIO CHUNKS WRITTEN AFTER THE
+   FRAME SO THEY REACH THE FILE IN THE SAME ORDER */
+typedef struct AGMV_ENCODE_SLOT{
+	u32 frame_num;
+	u32* img_data;
+	AGMV_ENTRY* img_entry;
+	AGMV_BITSTREAM bitstream;
+	AGMV_BITSTREAM chunk;
+	AGMV_BITSTREAM audio;
+	u32 audio_offset; /* START OF THE LAST AUDIO CHUNK IN AUDIO, THE ONE THE SEEK INDEX POINTS TO */
+	u8 flags;         /* SEEK INDEX FLAGS OF THE FINISHED CHUNK */
+}AGMV_ENCODE_SLOT;
+
+typedef struct AGMV_ENCODER{
+	AGMV_ENCODE_SLOT* slots;
+	u32 capacity;
+	u32 count;
+}AGMV_ENCODER;
+
 typedef struct AGMV{
 	AGMV_MAIN_HEADER header;
 	AGMV_FRAME_CHUNK* frame_chunk;
 	AGMV_AUDIO_CHUNK* audio_chunk;
 	AGMV_BITSTREAM* bitstream;
+	AGMV_BITSTREAM* payload;
 	AGMV_FRAME* frame;
 	AGMV_FRAME* iframe;
 	AGMV_AUDIO_TRACK* audio_track;
 	AGMV_ENTRY* iframe_entries;
+	AGMV_INDEX* index;
+	AGMV_THREAD_POOL* pool; /* NULL UNLESS MULTITHREADED DECODING OR ENCODING IS ENABLED */
+	AGMV_ENCODER* encoder; /* NULL UNLESS MULTITHREADED ENCODING IS ENABLED */
+	u32* row_offsets; /* BITSTREAM OFFSET OF EACH ROW OF BLOCKS FOR PARALLEL RENDERING */
+	u8* dirty; /* ONE BYTE PER 4X4 BLOCK, NONZERO IF THE LAST RENDER CHANGED IT */
+	Bool track_dirty;
+	u32* preview_iframe; /* LAST I-FRAME AT 1/4 SCALE, ALLOCATED BY THE FIRST PREVIEW DECODE */
 	AGMV_OPT opt;
 	AGMV_COMPRESSION compression;
+	u32 match_depth;
+	AGMV_LZ_PARSE lz77_parse;
 	u32 frame_count;
 	f32 leniency;
-	u32 offset_table[MAX_OFFSET_TABLE];
 	Bool enable_audio;
 	f32 volume;
 }AGMV;
 
+typedef struct AGMV_PACKET{
+	u32 frame_num;
+	u32 uncompressed_size;
+	u32 compressed_size;
+	u32 capacity;
+	u8* data;
+}AGMV_PACKET;
+
+typedef struct AGMV_DECODED_FRAME{
+	u32 frame_num;
+	u32 width;
+	u32 height;
+	u32* img_data;
+}AGMV_DECODED_FRAME;
+
+typedef void (*AGMV_PRESENT_FUNC)(void* userdata, const AGMV_DECODED_FRAME* frame);
+
+/* READER THREAD -> PACKET RING -> DECODE THREAD -> FRAME RING -> PRESENTATION ON THE CALLER'S THREAD */
+typedef struct AGMV_PLAYER{
+	FILE* file;
+	AGMV* agmv; /* OWNED BY THE DECODE THREAD ONCE PLAYBACK STARTS, THE HEADER IS SAFE TO READ */
+	AGMV_RING* packets;
+	AGMV_RING* frames;
+	AGMV_PACKET* packet_slots;
+	AGMV_DECODED_FRAME* frame_slots;
+	AGMV_THREAD reader;
+	AGMV_THREAD decoder;
+	AGMV_PRESENT_FUNC present;
+	void* userdata;
+	volatile u32 quit;
+	volatile u32 error;
+}AGMV_PLAYER;
+
+typedef struct AGMV_EXPORT_SLOT{
+	u32 number;   /* QUICK EXPORT SEQUENCE NUMBER, RESERVED IN ORDER BY THE DECODE THREAD */
+	u32* img_data;
+}AGMV_EXPORT_SLOT;
+
+/* DECODE THREAD -> BOUNDED QUEUE OF FRAME COPIES -> WRITER THREADS. FREE SLOTS ARE A STACK, PENDING SLOTS A FIFO */
+typedef struct AGMV_EXPORTER{
+	AGMV_THREAD* threads;
+	u32 num_of_threads;
+	AGMV_MUTEX lock;
+	AGMV_COND cond;
+	AGMV_EXPORT_SLOT* slots;
+	AGMV_EXPORT_SLOT** free_slots;
+	AGMV_EXPORT_SLOT** pending;
+	u32 capacity;
+	u32 num_of_free;
+	u32 pending_head;
+	u32 pending_count;
+	u32 width;
+	u32 height;
+	u8 img_type;
+	Bool closed;
+}AGMV_EXPORTER;
+
 typedef enum AGMV_IMG_TYPE{
 	AGMV_IMG_BMP = 0x1,
 	AGMV_IMG_TGA = 0x2,
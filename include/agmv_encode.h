@@ -27,11 +27,16 @@ u8 AGMV_ComparePFrameBlock(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry);
 u8 AGMV_CompareIFrameBlock(AGMV* agmv, u32 x, u32 y, u32 color, AGMV_ENTRY* img_entry);
 void AGMV_EncodeHeader(FILE* file, AGMV* agmv);
 void AGMV_EncodeFrame(FILE* file, AGMV* agmv, u32* img_data);
+void AGMV_FlushEncoder(FILE* file, AGMV* agmv);
 void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry);
 void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry);
 u32 AGMV_LZSS(FILE* file, AGMV_BITSTREAM* in);
+u32 AGMV_LZ77(FILE* file, AGMV_BITSTREAM* in);
+u32 AGMV_CompressLZSS(AGMV_BITSTREAM* out, AGMV_BITSTREAM* in, u32 depth);
+u32 AGMV_CompressLZ77(AGMV_BITSTREAM* out, AGMV_BITSTREAM* in, u32 depth, AGMV_LZ_PARSE parse);
 void AGMV_CompressAudio(AGMV* agmv);
 void AGMV_EncodeAudioChunk(FILE* file, AGMV* agmv);
+void AGMV_EncodeIndexChunk(FILE* file, AGMV* agmv);
 void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression);
 void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression);
 void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression);
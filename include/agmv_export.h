@@ -0,0 +1,26 @@
+#ifndef AGMV_EXPORT_H
+#define AGMV_EXPORT_H
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_export.h
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+#include <agmv_defines.h>
+
+/*-------ASYNCHRONOUS FRAME EXPORT------*/
+
+AGMV_EXPORTER* AGMV_CreateExporter(u32 width, u32 height, u8 img_type, u32 num_of_threads, u32 depth);
+void AGMV_ExportFrame(AGMV_EXPORTER* exporter, const u32* img_data);
+void AGMV_DestroyExporter(AGMV_EXPORTER* exporter);
+
+#endif
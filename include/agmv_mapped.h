@@ -0,0 +1,51 @@
+#ifndef AGMV_MAPPED_H
+#define AGMV_MAPPED_H
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_mapped.h
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+#include <agmv_defines.h>
+
+/*-------MEMORY MAPPED FILE UTILITY FUNCTIONS------*/
+
+AGMV_MAPPED_FILE* AGMV_OpenMapped(const char* filename);
+void AGMV_OpenMappedMemory(AGMV_MAPPED_FILE* file, const u8* data, u32 len);
+void AGMV_CloseMapped(AGMV_MAPPED_FILE* file);
+
+Bool AGMV_MappedEOF(AGMV_MAPPED_FILE* file);
+u32 AGMV_MappedTell(AGMV_MAPPED_FILE* file);
+void AGMV_MappedSeek(AGMV_MAPPED_FILE* file, u32 offset, int mode);
+
+u8 AGMV_MappedReadByte(AGMV_MAPPED_FILE* file);
+u16 AGMV_MappedReadShort(AGMV_MAPPED_FILE* file);
+u32 AGMV_MappedReadLong(AGMV_MAPPED_FILE* file);
+void AGMV_MappedReadFourCC(AGMV_MAPPED_FILE* file, char fourcc[4]);
+
+void AGMV_MappedFindNextFrameChunk(AGMV_MAPPED_FILE* file);
+void AGMV_MappedFindNextAudioChunk(AGMV_MAPPED_FILE* file);
+void AGMV_MappedSkipFrameChunk(AGMV_MAPPED_FILE* file);
+void AGMV_MappedSkipAudioChunk(AGMV_MAPPED_FILE* file);
+
+/*-------MEMORY MAPPED DECODING FUNCTIONS------*/
+
+int AGMV_DecodeMappedHeader(AGMV_MAPPED_FILE* file, AGMV* agmv);
+int AGMV_ReadMappedFrameChunk(AGMV_MAPPED_FILE* file, AGMV* agmv, const u8** payload, u32* csize);
+int AGMV_DecodeMappedFrameChunk(AGMV_MAPPED_FILE* file, AGMV* agmv);
+int AGMV_DecodeMappedFrameChunkToCanvas(AGMV_MAPPED_FILE* file, AGMV* agmv, AGMV_CANVAS* canvas, void* pixels, u32 stride);
+int AGMV_DecodeMappedFrameChunkPreview(AGMV_MAPPED_FILE* file, AGMV* agmv, u32* preview);
+int AGMV_DecodeMappedAudioChunk(AGMV_MAPPED_FILE* file, AGMV* agmv);
+int AGMV_DecodeMappedAudioChunkToRing(AGMV_MAPPED_FILE* file, AGMV* agmv, AGMV_AUDIO_RING* ring, u32* num_of_samples);
+int AGMV_LoadMappedIndex(AGMV_MAPPED_FILE* file, AGMV* agmv);
+
+#endif
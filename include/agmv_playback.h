@@ -25,9 +25,14 @@ Bool AGMV_IsVideoDone(AGMV* agmv);
 void AGMV_SkipForwards(FILE* file, AGMV* agmv, int n);
 void AGMV_SkipForwardsAndDecodeAudio(FILE* file, AGMV* agmv, int n);
 void AGMV_SkipBackwards(FILE* file, AGMV* agmv, int n);
+u32 AGMV_GetFrameOffset(FILE* file, AGMV* agmv, u32 n);
 void AGMV_SkipTo(FILE* file, AGMV* agmv, int n);
+/* DECODES FORWARD FROM THE NEAREST CLEAN I-FRAME AT OR BEFORE N, SO A SEEK COSTS UP TO N+1 DECODES WHEN NO EARLIER I-FRAME IS CLEAN */
+int AGMV_SeekToFrame(FILE* file, AGMV* agmv, u32 n);
 void AGMV_PlayAGMV(FILE* file, AGMV* agmv);
 void PlotPixel(u32* vram, int x, int y, int w, int h, u32 color);
 void AGMV_DisplayFrame(u32* vram, u16 width, u16 height, AGMV* agmv);
+void AGMV_BlitFrame(u32* vram, u32 width, u32 height, AGMV* agmv, int x, int y, u32 scale);
+u32 AGMV_LetterboxFrame(u32* vram, u32 width, u32 height, AGMV* agmv, u32 border_color);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef AGMV_PLAYER_H
+#define AGMV_PLAYER_H
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_player.h
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+#include <agmv_defines.h>
+
+/*-------PIPELINED PLAYBACK ENGINE------*/
+
+AGMV_PLAYER* AGMV_OpenPlayer(const char* filename, u32 num_of_frames, AGMV_PRESENT_FUNC present, void* userdata);
+Bool AGMV_PlayerPresent(AGMV_PLAYER* player, Bool wait);
+u32 AGMV_GetPlayerBufferedFrames(AGMV_PLAYER* player);
+Bool AGMV_IsPlayerDone(AGMV_PLAYER* player);
+int AGMV_GetPlayerError(AGMV_PLAYER* player);
+void AGMV_ClosePlayer(AGMV_PLAYER* player);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef AGMV_SIMD_H
+#define AGMV_SIMD_H
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_simd.h
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+#include <agmv_defines.h>
+
+/*-------SIMD BLOCK KERNEL DISPATCH------*/
+
+/* THE KERNEL TABLE IS PROCESS WIDE. AGMV_SetSIMD MUST BE CALLED BEFORE ANY DECODING STARTS, NOT WHILE FRAMES ARE RENDERING */
+
+AGMV_SIMD AGMV_GetSIMD();
+void AGMV_SetSIMD(AGMV_SIMD simd);
+Bool AGMV_IsSIMDSupported(AGMV_SIMD simd);
+const AGMV_BLOCK_KERNELS* AGMV_GetBlockKernels();
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef AGMV_THREAD_H
+#define AGMV_THREAD_H
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_thread.h
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+#include <agmv_defines.h>
+
+/*-------THREADING PRIMITIVES------*/
+
+AGMV_THREAD AGMV_CreateThread(AGMV_THREAD_FUNC func, void* data);
+void AGMV_JoinThread(AGMV_THREAD thread);
+AGMV_MUTEX AGMV_CreateMutex();
+void AGMV_DestroyMutex(AGMV_MUTEX mutex);
+void AGMV_LockMutex(AGMV_MUTEX mutex);
+void AGMV_UnlockMutex(AGMV_MUTEX mutex);
+AGMV_COND AGMV_CreateCond();
+void AGMV_DestroyCond(AGMV_COND cond);
+void AGMV_WaitCond(AGMV_COND cond, AGMV_MUTEX mutex);
+void AGMV_SignalCond(AGMV_COND cond);
+void AGMV_BroadcastCond(AGMV_COND cond);
+u32 AGMV_GetNumberOfCores();
+u32 AGMV_AtomicLoad(volatile u32* value);
+void AGMV_AtomicStore(volatile u32* value, u32 num);
+void AGMV_AtomicFence();
+void AGMV_SleepMS(u32 ms);
+
+/*-------THREAD POOL------*/
+
+AGMV_THREAD_POOL* AGMV_CreateThreadPool(u32 num_of_threads);
+void AGMV_ThreadPoolRun(AGMV_THREAD_POOL* pool, AGMV_TASK task, void* data, u32 count);
+void AGMV_DestroyThreadPool(AGMV_THREAD_POOL* pool);
+
+/*-------SINGLE PRODUCER SINGLE CONSUMER RING------*/
+
+AGMV_RING* AGMV_CreateRing(u32 capacity);
+void AGMV_DestroyRing(AGMV_RING* ring);
+void* AGMV_RingBeginWrite(AGMV_RING* ring, Bool wait);
+void AGMV_RingEndWrite(AGMV_RING* ring);
+void* AGMV_RingBeginRead(AGMV_RING* ring, Bool wait);
+void AGMV_RingEndRead(AGMV_RING* ring);
+u32 AGMV_RingCount(AGMV_RING* ring);
+void AGMV_CloseRing(AGMV_RING* ring);
+Bool AGMV_IsRingDrained(AGMV_RING* ring);
+
+#endif
@@ -22,21 +22,29 @@
 
 Bool AGMV_EOF(FILE* file);
 
-u32 AGMV_ReadBits(FILE* file, u32 num_of_bits);
+u32 AGMV_ReadBits(FILE* file, AGMV_BITSTREAM* stream, u32 num_of_bits);
 u8 AGMV_ReadByte(FILE* file);
 u16 AGMV_ReadShort(FILE* file);
 u32 AGMV_ReadLong(FILE* file);
 void AGMV_ReadFourCC(FILE* file, char fourcc[4]);
 
-void AGMV_WriteBits(FILE* file, u32 num, u16 num_of_bits);
+void AGMV_WriteBits(FILE* file, AGMV_BITSTREAM* stream, u32 num, u16 num_of_bits);
 void AGMV_WriteByte(FILE* file, u8 byte);
 void AGMV_WriteShort(FILE* file, u16 word);
 void AGMV_WriteLong(FILE* file, u32 dword);
 void AGMV_WriteFourCC(FILE* file, char f, char o, char u, char r);
 
-void AGMV_FlushReadBits();
-void AGMV_FlushWriteBits(FILE* file);
+void AGMV_ReserveBitstream(AGMV_BITSTREAM* stream, u32 len);
+void AGMV_PutBits(AGMV_BITSTREAM* stream, u32 num, u16 num_of_bits);
+void AGMV_PutByte(AGMV_BITSTREAM* stream, u8 byte);
+void AGMV_PutShort(AGMV_BITSTREAM* stream, u16 word);
+void AGMV_PutLong(AGMV_BITSTREAM* stream, u32 dword);
+void AGMV_PutFourCC(AGMV_BITSTREAM* stream, char f, char o, char u, char r);
 
+void AGMV_FlushReadBits(AGMV_BITSTREAM* stream);
+void AGMV_FlushWriteBits(FILE* file, AGMV_BITSTREAM* stream);
+
+Bool AGMV_FindNextChunk(FILE* file, char f, char o, char u, char r);
 void AGMV_FindNextFrameChunk(FILE* file);
 void AGMV_FindNextAudioChunk(FILE* file);
 
@@ -44,6 +52,12 @@ void AGMV_SkipFrameChunk(FILE* file);
 void AGMV_SkipAudioChunk(FILE* file);
 
 void AGMV_ParseAGMV(FILE* file, AGMV* agmv);
+u32 AGMV_GetHeaderSize(AGMV* agmv);
+AGMV_INDEX_ENTRY* AGMV_ReserveIndexEntry(AGMV* agmv, u32 n);
+void AGMV_SetIndexFrameOffset(AGMV* agmv, u32 n, u32 frame_offset, u8 flags);
+void AGMV_RecordFrameOffset(AGMV* agmv, u32 n, u32 frame_offset);
+void AGMV_SetIndexAudioOffset(AGMV* agmv, u32 n, u32 audio_offset);
+int AGMV_LoadIndex(FILE* file, AGMV* agmv);
 
 Bool AGMV_IsCorrectFourCC(char fourcc[4], char f, char o, char u, char r);
 
@@ -63,11 +77,17 @@ void AGMV_SetLeniency(AGMV* agmv, f32 leniency);
 void AGMV_SetOPT(AGMV* agmv, AGMV_OPT opt);
 void AGMV_SetVersion(AGMV* agmv, u8 version);
 void AGMV_SetCompression(AGMV* agmv, AGMV_COMPRESSION compression);
+void AGMV_SetMatchDepth(AGMV* agmv, u32 depth);
+void AGMV_SetLZ77Parse(AGMV* agmv, AGMV_LZ_PARSE parse);
 void AGMV_SetAudioState(AGMV* agmv, Bool audio);
 void AGMV_SetVolume(AGMV* agmv, f32 volume);
 void AGMV_SetBitsPerSample(AGMV* agmv, u16 bits_per_sample);
+void AGMV_SetDecodeThreads(AGMV* agmv, u32 num_of_threads);
+void AGMV_SetEncodeThreads(AGMV* agmv, u32 num_of_threads);
+void AGMV_SetDirtyTracking(AGMV* agmv, Bool track_dirty);
 
 AGMV* CreateAGMV(u32 num_of_frames, u32 width, u32 height, u32 frames_per_second);
+AGMV* AGMV_AllocDecoder();
 void DestroyAGMV(AGMV* agmv);
 
 /*------PRIMARY FUNCTIONS TO RETRIEVE AGMV ATTRIBUTES----------*/
@@ -84,9 +104,13 @@ f32 AGMV_GetLeniency(AGMV* agmv);
 u8 AGMV_GetVersion(AGMV* agmv);
 AGMV_OPT AGMV_GetOPT(AGMV* agmv);
 AGMV_COMPRESSION AGMV_GetCompression(AGMV* agmv);
+u32 AGMV_GetMatchDepth(AGMV* agmv);
+AGMV_LZ_PARSE AGMV_GetLZ77Parse(AGMV* agmv);
 Bool AGMV_GetAudioState(AGMV* agmv);
 f32 AGMV_GetVolume(AGMV* agmv);
 u16 AGMV_GetBitsPerSample(AGMV* agmv);
+const u8* AGMV_GetDirtyBlocks(AGMV* agmv);
+u32 AGMV_GetDirtyRects(AGMV* agmv, AGMV_RECT* rects, u32 max_rects);
 
 /*-----------------VARIOUS UTILITY FUNCTIONS-----------------*/
 int AGMV_NextIFrame(int n, int frame_count);
@@ -97,10 +121,18 @@ f32 AGMV_ClampVolume(f32 volume);
 u16 AGMV_SwapShort(u16 word);
 u32 AGMV_SwapLong(u32 dword);
 void AGMV_CopyImageData(u32* dest, u32* src, u32 size);
+u8* AGMV_ResizeBitstream(AGMV_BITSTREAM* bitstream, u32 len);
+u32 AGMV_GetPixelSize(AGMV_PIXEL_FMT fmt);
+u32 AGMV_ConvertColor(u8 r, u8 g, u8 b, AGMV_PIXEL_FMT fmt);
 void AGMV_SyncFrameAndImage(AGMV* agmv, u32* img_data);
 void AGMV_SyncAudioTrack(AGMV* agmv, const void* pcm);
 void AGMV_SignedToUnsignedPCM(u8* pcm, u32 size);
 void AGMV_UnsigendToSignedPCM(u8* pcm, u32 size);
+AGMV_AUDIO_RING* AGMV_CreateAudioRing(u32 capacity, u16 bits_per_sample);
+void AGMV_DestroyAudioRing(AGMV_AUDIO_RING* ring);
+u32 AGMV_GetAudioRingCount(AGMV_AUDIO_RING* ring);
+u32 AGMV_GetAudioRingSpace(AGMV_AUDIO_RING* ring);
+u32 AGMV_ReadAudioRing(AGMV_AUDIO_RING* ring, void* dest, u32 num_of_samples);
 int AGMV_Abs(int a);
 int AGMV_Min(int a, int b);
 u8 AGMV_GetR(u32 color);
@@ -119,6 +151,8 @@ u32 AGMV_CalculateTotalAudioDuration(u32 size, u32 sample_rate, u16 num_of_chann
 f32 AGMV_CompareFrameSimilarity(u32* frame1, u32* frame2 , u32 width, u32 height);
 void AGMV_InterpFrame(u32* interp, u32* frame1, u32* frame2, u32 width, u32 height);
 void AGMV_BubbleSort(u32* data, u32* gram, u32 num_of_colors);
+void AGMV_RadixSort(u32* data, u32* gram, u32 num_of_colors);
+void AGMV_BuildPalettes(u32* histogram, u32 max_clr, AGMV_QUALITY quality, AGMV_OPT opt, u32 palette0[256], u32 palette1[256]);
 char* AGMV_Error2Str(Error error);
 u32 AGMV_GetNumberOfBytesRead(u32 bits);
 void AGMV_WavToAudioTrack(const char* filename, AGMV* agmv);
@@ -129,6 +163,8 @@ void AGMV_AIFFToAudioTrack(const char* filename, AGMV* agmv);
 void AGMV_Raw8PCMToAudioTrack(const char* filename, AGMV* agmv);
 AGMV_INFO AGMV_GetVideoInfo(AGMV* agmv);
 int AGMV_ResetFrameRate(const char* filename, u32 frames_per_second);
+void AGMV_ExportAudioHeader(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type);
+void AGMV_ExportAudioSamples(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type, const void* pcm, u32 num_of_samples);
 void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type);
 void AGMV_ExportAGMVToHeader(const char* filename);
 
@@ -14,9 +14,14 @@
 ********************************************/
 #include <agidl.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <agmv_decode.h>
 #include <agmv_utils.h>
+#include <agmv_thread.h>
+#include <agmv_simd.h>
+#include <agmv_mapped.h>
+#include <agmv_export.h>
 
 u16 AGMV_SQR_TABLE[256] = {
 	0,1,4,9,16,25,36,49,64,
@@ -139,120 +144,373 @@ int AGMV_DecodeHeader(FILE* file, AGMV* agmv){
 		}
 	}
 	
+	AGMV_DecodeIndexPointer(file,agmv);
+	
 	return NO_ERR;
 }
 
-int AGMV_DecodeFrameChunk(FILE* file, AGMV* agmv){
-	u32 pos, i, bitpos = 0, bits = 0, num_of_bits, size = agmv->header.width * agmv->header.height, width, height, bpos = 0, usize, csize, indice;	
-	u32* img_data = agmv->frame->img_data, *iframe_data = agmv->iframe->img_data, *palette, color, offset;
-	u8 byte, len, org, index, fbit, bot, *bitstream_data = agmv->bitstream->data;
-	Bool escape = FALSE, invalid_flag = FALSE;
+void AGMV_DecodeIndexPointer(FILE* file, AGMV* agmv){
+	char fourcc[4];
+	
+	agmv->header.index_offset = 0;
+	
+	AGMV_ReadFourCC(file,fourcc);
+	
+	if(AGMV_IsCorrectFourCC(fourcc,'A','G','I','P')){
+		agmv->header.index_offset = AGMV_ReadLong(file);
+	}
+	else{
+		fseek(file,-4,SEEK_CUR);
+	}
+}
 
-	agmv->bitstream->pos = 0;
+/* COPIES ONE LZ MATCH WITH THE SAME RESULT AS THE ORIGINAL PER BYTE LOOP THAT ONLY COPIED WHILE POS - OFFSET + I < BPOS,
+   WHICH MEANS AN OFFSET OF ZERO COPIES NOTHING AND AN OFFSET REACHING BEFORE THE START OF THE BUFFER SKIPS THE FIRST OFFSET - POS BYTES
+   AND THEN REPEATS FROM THE START OF THE BUFFER */
+static u32 AGMV_CopyMatch(u8* dest, u32 bpos, u32 offset, u32 len, u32 capacity){
+	u32 src, dist, n;
 	
-	AGMV_ReadFourCC(file,agmv->frame_chunk->fourcc);
-	agmv->frame_chunk->frame_num = AGMV_ReadLong(file);
-	agmv->frame_chunk->uncompressed_size = AGMV_ReadLong(file);
-	agmv->frame_chunk->compressed_size = AGMV_ReadLong(file);
+	if(offset == 0 || bpos == 0){
+		return bpos;
+	}
 	
-	width  = agmv->frame->width;
-	height = agmv->frame->height;
+	if(offset > bpos){
+		if(offset - bpos >= len){
+			return bpos;
+		}
+		len -= offset - bpos;
+		src = 0;
+	}
+	else{
+		src = bpos - offset;
+	}
 	
-	usize = agmv->frame_chunk->uncompressed_size;
-	csize = agmv->frame_chunk->compressed_size;
+	if(len > capacity - bpos){
+		len = capacity - bpos;
+	}
 	
-	num_of_bits = agmv->frame_chunk->compressed_size * 8;
-	bpos = agmv->bitstream->pos;
+	dist = bpos - src;
 	
-	if(!AGMV_IsCorrectFourCC(agmv->frame_chunk->fourcc,'A','G','F','C')){
-		return INVALID_HEADER_FORMATTING_ERR;
+	if(dist >= len){
+		memcpy(dest + bpos,dest + src,len);
+		return bpos + len;
 	}
 	
-	if(agmv->header.version == 1 || agmv->header.version == 2){
-		for(bits = 0; bits < num_of_bits && bpos < usize;){
+	/* OVERLAPPING MATCH, THE SOURCE REPEATS EVERY DIST BYTES SO COPY IT IN NON-OVERLAPPING RUNS THAT DOUBLE IN SIZE */
+	n = len;
+	while(n > 0){
+		u32 run = dist < n ? dist : n;
+		memcpy(dest + bpos,dest + src,run);
+		bpos += run;
+		n -= run;
+		dist += run;
+	}
+	
+	return bpos;
+}
 
-			byte = AGMV_ReadBits(file,1); bits++;
+u32 AGMV_DecompressLZSS(const u8* src, u32 csize, u8* dest, u32 usize, u32 capacity){
+	u32 bits, num_of_bits = csize * 8, bpos = 0, offset, len, pos = 0, acc = 0, bitsin = 0;
+	
+	if(usize > capacity){
+		usize = capacity;
+	}
+	
+	for(bits = 0; bits < num_of_bits && bpos < usize;){
+		/* KEEP AT LEAST 25 BITS BUFFERED, ENOUGH FOR A WHOLE TOKEN. THE ENCODER FLOORS THE COMPRESSED SIZE AND PADS
+		   EVERY CHUNK WITH 0xFF, SO ANY BITS REQUESTED PAST THE END OF THE PAYLOAD READ BACK AS SET */
+		while(bitsin <= 24){
+			acc |= (u32)(pos < csize ? src[pos++] : 0xFF) << bitsin;
+			bitsin += 8;
+		}
+		
+		if(acc & 1){
+			dest[bpos++] = (acc >> 1) & 0xff;
+			acc >>= 9;
+			bitsin -= 9;
+			bits += 9;
 			
-			if(byte & 1){
-				if(bpos >= usize) {
-					break;
-				}
-				bitstream_data[bpos++] = AGMV_ReadBits(file,8);
-				bits += 8;
+			/* TIGHT LOOP FOR RUNS OF LITERALS WHILE A WHOLE LITERAL IS STILL BUFFERED */
+			while(bitsin >= 9 && (acc & 1) && bits < num_of_bits && bpos < usize){
+				dest[bpos++] = (acc >> 1) & 0xff;
+				acc >>= 9;
+				bitsin -= 9;
+				bits += 9;
 			}
-			else{
-				offset = AGMV_ReadBits(file,16);
-				len = AGMV_ReadBits(file,4);
-				
-				bits += 20;
-				
-				pos = bpos;
+		}
+		else{
+			offset = (acc >> 1) & 0xffff;
+			len = (acc >> 17) & 0xf;
+			acc >>= 21;
+			bitsin -= 21;
+			bits += 21;
+			
+			bpos = AGMV_CopyMatch(dest,bpos,offset,len,capacity);
+		}
+	}
+	
+	return bpos;
+}
 
-				int i;
-				for (i = 0; i < len; i++) {
-					if (pos - offset + i >= 0 && pos - offset + i < bpos) {
-						bitstream_data[bpos++] = bitstream_data[pos - offset + i];
-					}
-				}
-			}
+u32 AGMV_DecompressLZ77(const u8* src, u32 csize, u8* dest, u32 capacity){
+	u32 bpos = 0, offset, i;
+	
+	for(i = 0; i + 4 <= csize && bpos < capacity; i += 4){
+		offset = src[i] | (src[i+1] << 8);
+		
+		bpos = AGMV_CopyMatch(dest,bpos,offset,src[i+2],capacity);
+		
+		if(bpos < capacity){
+			dest[bpos++] = src[i+3];
+		}
+	}
+	
+	return bpos;
+}
+
+AGMV_CANVAS* AGMV_CreateCanvas(AGMV* agmv, AGMV_PIXEL_FMT fmt){
+	AGMV_CANVAS* canvas = (AGMV_CANVAS*)malloc(sizeof(AGMV_CANVAS));
+	
+	canvas->fmt = fmt;
+	canvas->bpp = AGMV_GetPixelSize(fmt);
+	canvas->width = AGMV_GetWidth(agmv);
+	canvas->height = AGMV_GetHeight(agmv);
+	canvas->iframe = (u8*)calloc(canvas->width*canvas->height,canvas->bpp);
+	
+	AGMV_SyncCanvasPalette(canvas,agmv);
+	
+	return canvas;
+}
+
+static u32 AGMV_ConvertPaletteColor(AGMV* agmv, u32 color, AGMV_PIXEL_FMT fmt){
+	if(agmv->header.fmt == AGIDL_BGR_888){
+		return AGMV_ConvertColor(AGMV_GetB(color),AGMV_GetG(color),AGMV_GetR(color),fmt);
+	}
+	else{
+		return AGMV_ConvertColor(AGMV_GetR(color),AGMV_GetG(color),AGMV_GetB(color),fmt);
+	}
+}
+
+/* INDEX FORMATS RENDER THROUGH IDENTITY PALETTES, SO EVERY PIXEL WRITTEN IS THE PALETTE ENTRY ITSELF RATHER THAN ITS COLOR */
+void AGMV_SyncCanvasPalette(AGMV_CANVAS* canvas, AGMV* agmv){
+	int i;
+	for(i = 0; i < 256; i++){
+		if(canvas->fmt == AGMV_PIXEL_INDEX8 || canvas->fmt == AGMV_PIXEL_INDEX16){
+			canvas->palette0[i] = i;
+			canvas->palette1[i] = canvas->fmt == AGMV_PIXEL_INDEX16 ? 0x100 | i : i;
+		}
+		else{
+			canvas->palette0[i] = AGMV_ConvertPaletteColor(agmv,agmv->header.palette0[i],canvas->fmt);
+			canvas->palette1[i] = AGMV_ConvertPaletteColor(agmv,agmv->header.palette1[i],canvas->fmt);
 		}
 	}
+}
+
+/* THE INDEX FORMAT THAT LOSES NOTHING FOR THIS FILE */
+AGMV_PIXEL_FMT AGMV_GetIndexFormat(AGMV* agmv){
+	if(agmv->header.version == 1 || agmv->header.version == 3){
+		return AGMV_PIXEL_INDEX16;
+	}
 	else{
-		for(i = 0; i < csize; i += 4){
-			
-			offset = AGMV_ReadShort(file);
-			len = AGMV_ReadByte(file);	
-			byte = AGMV_ReadByte(file);
-			
-			pos = bpos;
-			
-			int i;
-			for (i = 0; i < len; i++) {
-				if (pos - offset + i >= 0 && pos - offset + i < bpos) {
-					bitstream_data[bpos++] = bitstream_data[pos - offset + i];
-				}
-			}
-			
-			bitstream_data[bpos++] = byte;
+		return AGMV_PIXEL_INDEX8;
+	}
+}
+
+/* FILLS LUT SO THAT LUT[V] IS THE COLOR, IN FMT, OF INDEX PLANE VALUE V. RETURNS THE NUMBER OF ENTRIES WRITTEN, 256 FOR
+   ONE PALETTE FILES AND 512 FOR TWO, SO LUT MUST HOLD 512 ENTRIES UNLESS THE FILE IS KNOWN TO USE ONE PALETTE */
+u32 AGMV_GetPaletteLUT(AGMV* agmv, AGMV_PIXEL_FMT fmt, u32* lut){
+	u32 count = AGMV_GetIndexFormat(agmv) == AGMV_PIXEL_INDEX16 ? 512 : 256;
+	
+	int i;
+	for(i = 0; i < 256; i++){
+		lut[i] = AGMV_ConvertPaletteColor(agmv,agmv->header.palette0[i],fmt);
+		
+		if(count == 512){
+			lut[256+i] = AGMV_ConvertPaletteColor(agmv,agmv->header.palette1[i],fmt);
 		}
 	}
+	
+	return count;
+}
+
+void AGMV_DestroyCanvas(AGMV_CANVAS* canvas){
+	if(canvas != NULL){
+		free(canvas->iframe);
+		free(canvas);
+	}
+}
+
+int AGMV_ReadFrameChunk(FILE* file, AGMV* agmv, u32* csize){
+	AGMV_ReadFourCC(file,agmv->frame_chunk->fourcc);
+	agmv->frame_chunk->frame_num = AGMV_ReadLong(file);
+	agmv->frame_chunk->uncompressed_size = AGMV_ReadLong(file);
+	agmv->frame_chunk->compressed_size = AGMV_ReadLong(file);
+	
+	if(!AGMV_IsCorrectFourCC(agmv->frame_chunk->fourcc,'A','G','F','C')){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	AGMV_ResizeBitstream(agmv->payload,agmv->frame_chunk->compressed_size + 1);
+	*csize = fread(agmv->payload->data,1,agmv->frame_chunk->compressed_size,file);
+	
+	return NO_ERR;
+}
+
+int AGMV_DecodeFrameChunk(FILE* file, AGMV* agmv){
+	u32 csize;
+	int err = AGMV_ReadFrameChunk(file,agmv,&csize);
+	
+	if(err != NO_ERR){
+		return err;
+	}
+	
+	return AGMV_DecodeFramePayload(agmv,agmv->payload->data,csize);
+}
+
+int AGMV_DecodeFrameChunkToCanvas(FILE* file, AGMV* agmv, AGMV_CANVAS* canvas, void* pixels, u32 stride){
+	u32 csize;
+	int err = AGMV_ReadFrameChunk(file,agmv,&csize);
+	
+	if(err != NO_ERR){
+		return err;
+	}
+	
+	return AGMV_DecodeFramePayloadToCanvas(agmv,canvas,agmv->payload->data,csize,pixels,stride);
+}
 
+u32 AGMV_DecompressFrame(AGMV* agmv, const u8* payload, u32 csize){
+	u32 bpos, size = agmv->header.width * agmv->header.height;
+	u8* bitstream_data = AGMV_ResizeBitstream(agmv->bitstream,size*2);
+	
+	if(agmv->header.version == 1 || agmv->header.version == 2){
+		bpos = AGMV_DecompressLZSS(payload,csize,bitstream_data,agmv->frame_chunk->uncompressed_size,agmv->bitstream->len);
+	}
+	else{
+		bpos = AGMV_DecompressLZ77(payload,csize,bitstream_data,agmv->bitstream->len);
+	}
+	
 	agmv->bitstream->pos = bpos;
+	
+	return bpos;
+}
 
-	AGMV_FlushReadBits();
+/* BPP IS EITHER A CANVAS PIXEL SIZE(1, 2, OR 4 BYTES) OR SIZEOF(U32) FOR THE NATIVE AGMV_FRAME */
+static u32 AGMV_GetPixel(const u8* dest, u32 bpp){
+	if(bpp == sizeof(u32)){
+		return *(const u32*)dest;
+	}
+	switch(bpp){
+		case 4: return *(const unsigned int*)dest;
+		case 2: return *(const u16*)dest;
+		default: return *dest;
+	}
+}
 
-	if(agmv->header.version == 1 || agmv->header.version == 3){
-		int x,y;
-		for(y = 0; y < height && escape != TRUE; y += 4){
-			for(x = 0; x < width && escape != TRUE; x += 4){
+static void AGMV_PutPixel(u8* dest, u32 bpp, u32 color){
+	if(bpp == sizeof(u32)){
+		*(u32*)dest = color;
+		return;
+	}
+	switch(bpp){
+		case 4: *(unsigned int*)dest = color; break;
+		case 2: *(u16*)dest = color; break;
+		default: *dest = color; break;
+	}
+}
+
+typedef struct AGMV_RENDER_JOB{
+	AGMV* agmv;
+	const u8* bitstream_data;
+	u32 bpos;
+	u8* dest;
+	u32 stride;
+	u32 bpp;
+	const u32* palette0;
+	const u32* palette1;
+	const u8* iframe;
+	u32 iframe_stride;
+	const u32* row_offsets;
+	u32 rows_per_task;
+	u32 num_of_rows;
+	const AGMV_BLOCK_KERNELS* kernels;
+	Bool two_palettes;
+	u8* dirty; /* NULL UNLESS THE CALLER ASKED FOR DIRTY BLOCKS */
+	u8 lut[256*8+8]; /* PALETTE INDEX TO DESTINATION PIXEL, BPP BYTES PER ENTRY */
+}AGMV_RENDER_JOB;
+
+/* SAVES A 4X4 BLOCK, OR COMPARES ONE AGAINST ANOTHER, BPP BYTES PER PIXEL */
+static void AGMV_SaveBlock(u8* saved, const u8* block, u32 stride, u32 bpp){
+	int j;
+	for(j = 0; j < 4; j++){
+		memcpy(saved + j*4*bpp,block + j*stride,4*bpp);
+	}
+}
+
+static Bool AGMV_BlockDiffers(const u8* a, u32 astride, const u8* b, u32 bstride, u32 bpp){
+	int j;
+	for(j = 0; j < 4; j++){
+		if(memcmp(a + j*astride,b + j*bstride,4*bpp) != 0){
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* RENDERS ROWS OF BLOCKS [ROW, END_ROW) STARTING FROM BITSTREAM OFFSET BITPOS. RETURNS FALSE IF ANY BLOCK WAS COPIED FROM THE
+   I-FRAME OR LEFT UNTOUCHED BY AN EARLY ESCAPE, I.E. IF THE RESULT DEPENDS ON EARLIER FRAMES */
+static Bool AGMV_RenderRows(const AGMV_RENDER_JOB* job, u32 row, u32 end_row, u32 bitpos){
+	AGMV* agmv = job->agmv;
+	const u8* bitstream_data = job->bitstream_data;
+	const u32* palette0 = job->palette0, *palette1 = job->palette1;
+	const u8* iframe = job->iframe;
+	u32 bpos = job->bpos, stride = job->stride, bpp = job->bpp, iframe_stride = job->iframe_stride;
+	u32 width = agmv->frame->width, height = agmv->frame->height, color;
+	u8* dest = job->dest;
+	const AGMV_BLOCK_KERNELS* kernels = job->kernels;
+	const u32* palette;
+	u8 byte, index, fbit, bot, *block, *dirty = job->dirty, saved[16*8];
+	Bool escape = FALSE, invalid_flag = FALSE, copied = FALSE;
+	Bool two_palettes = job->two_palettes;
+	
+	int x,y;
+	for(y = row*4; y < end_row*4 && y < height && escape != TRUE; y += 4){
+		for(x = 0; x < width && escape != TRUE; x += 4){
+			
+			if(bitpos > bpos){
+				escape = TRUE;
+				break;
+			}
+			
+			byte = bitstream_data[bitpos++];
+			
+			while(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				byte = bitstream_data[bitpos++];
 				
 				if(bitpos > bpos){
 					escape = TRUE;
 					break;
 				}
-
-				byte = bitstream_data[bitpos++];
-				
-				while(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
-					byte = bitstream_data[bitpos++];
-					
-					if(bitpos > bpos){
-						escape = TRUE;
-						break;
-					}
-				}
-
-				if(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
-					invalid_flag = TRUE;
-				}
+			}
+			
+			if(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				invalid_flag = TRUE;
+			}
+			
+			block = dest + y*stride + x*bpp;
+			
+			if(dirty != NULL && byte != AGMV_COPY_FLAG){
+				AGMV_SaveBlock(saved,block,stride,bpp);
+			}
+			
+			if(byte == AGMV_FILL_FLAG){
+				index = bitstream_data[bitpos++];
 				
-				if(byte == AGMV_FILL_FLAG){
-					index = bitstream_data[bitpos++]; 
+				if(two_palettes){
 					fbit = (index >> 7) & 1;
 					bot = (index & 0x7f);
 					
-					palette = fbit ? agmv->header.palette1 : agmv->header.palette0;
-			
+					palette = fbit ? palette1 : palette0;
+					
 					if(bot < 127){
 						color = palette[bot];
 					}
@@ -260,45 +518,51 @@ int AGMV_DecodeFrameChunk(FILE* file, AGMV* agmv){
 						index = bitstream_data[bitpos++];
 						color = palette[index];
 					}
-					
-					if(x == width-4 && y == height-4){
-						color = img_data[(x-1)+(y+1)*width];
-					}
-					
-					if(bitpos > bpos){
-						escape = TRUE;
-						break;
-					}
-					
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							img_data[(x+i)+offset] = color;
-						}
-					}
 				}
-				else if(byte == AGMV_COPY_FLAG){
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							indice = (x+i)+offset;
-							img_data[indice] = iframe_data[indice];
-						}
+				else{
+					color = palette0[index];
+				}
+				
+				if(x == width-4 && y == height-4){
+					color = AGMV_GetPixel(dest + (y+1)*stride + (x-1)*(int)bpp,bpp);
+				}
+				
+				if(bitpos > bpos){
+					escape = TRUE;
+					break;
+				}
+				
+				kernels->fill(block,stride,bpp,color);
+			}
+			else if(byte == AGMV_COPY_FLAG){
+				/* A COPY BLOCK ONLY CHANGES THE DESTINATION IF IT NO LONGER MATCHES THE I-FRAME */
+				if(dirty == NULL || AGMV_BlockDiffers(block,stride,iframe + y*iframe_stride + x*bpp,iframe_stride,bpp)){
+					kernels->copy(block,stride,iframe + y*iframe_stride + x*bpp,iframe_stride,bpp);
+					
+					if(dirty != NULL){
+						dirty[(y/4)*((width+3)/4) + x/4] = 1;
 					}
 				}
-				else{
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							index = bitstream_data[bitpos++];
+				copied = TRUE;
+				continue;
+			}
+			else if(invalid_flag != TRUE && bitpos + 16 <= bpos && (!two_palettes || !kernels->escapes(bitstream_data + bitpos))){
+				/* NO ESCAPE CAN HAPPEN INSIDE THIS BLOCK, SO ALL 16 INDICES MAP STRAIGHT THROUGH THE LUT */
+				kernels->gather(block,stride,bpp,bitstream_data + bitpos,job->lut);
+				bitpos += 16;
+			}
+			else{
+				int i,j;
+				for(j = 0; j < 4; j++){
+					for(i = 0; i < 4; i++){
+						index = bitstream_data[bitpos++];
+						
+						if(two_palettes){
 							fbit = (index >> 7) & 1;
 							bot = (index & 0x7f);
 							
-							palette = fbit ? agmv->header.palette1 : agmv->header.palette0;
-					
+							palette = fbit ? palette1 : palette0;
+							
 							if(bot < 127){
 								color = palette[bot];
 							}
@@ -306,114 +570,343 @@ int AGMV_DecodeFrameChunk(FILE* file, AGMV* agmv){
 								index = bitstream_data[bitpos++];
 								color = palette[index];
 							}
-							
-							if(bitpos > bpos || invalid_flag == TRUE){
-								escape = TRUE;
-								invalid_flag = FALSE;
-								break;
-							}
-							
-							img_data[(x+i)+offset] = color;
 						}
+						else{
+							color = palette0[index];
+						}
+						
+						if(bitpos > bpos || invalid_flag == TRUE){
+							escape = TRUE;
+							invalid_flag = FALSE;
+							break;
+						}
+						
+						AGMV_PutPixel(block + j*stride + i*bpp,bpp,color);
 					}
 				}
 			}
+			
+			if(dirty != NULL){
+				dirty[(y/4)*((width+3)/4) + x/4] = AGMV_BlockDiffers(saved,4*bpp,block,stride,bpp);
+			}
 		}
 	}
-	else{
-		u32* palette0 = agmv->header.palette0;
+	
+	return escape != TRUE && copied != TRUE;
+}
+
+/* WALKS THE BITSTREAM EXACTLY LIKE AGMV_RenderRows WITHOUT TOUCHING ANY PIXELS, RECORDING WHERE EACH ROW OF BLOCKS BEGINS IF
+   ROW_OFFSETS IS NOT NULL. ROWS THE SEQUENTIAL DECODER WOULD NEVER REACH GET AN OFFSET PAST BPOS SO THEY ESCAPE IMMEDIATELY */
+static Bool AGMV_ScanRows(const AGMV_RENDER_JOB* job, u32* row_offsets){
+	const u8* bitstream_data = job->bitstream_data;
+	u32 bitpos = 0, bpos = job->bpos, width = job->agmv->frame->width, row, x, i;
+	u8 byte, index;
+	Bool escape = FALSE, invalid_flag = FALSE, copied = FALSE;
+	Bool two_palettes = job->two_palettes;
+	
+	for(row = 0; row < job->num_of_rows; row++){
+		if(escape == TRUE){
+			if(row_offsets != NULL){
+				row_offsets[row] = bpos + 1;
+			}
+			continue;
+		}
+		
+		if(row_offsets != NULL){
+			row_offsets[row] = bitpos;
+		}
 		
-		int x,y;
-		for(y = 0; y < height && escape != TRUE; y += 4){
-			for(x = 0; x < width && escape != TRUE; x += 4){
+		for(x = 0; x < width && escape != TRUE; x += 4){
+			
+			if(bitpos > bpos){
+				escape = TRUE;
+				break;
+			}
+			
+			byte = bitstream_data[bitpos++];
+			
+			while(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				byte = bitstream_data[bitpos++];
 				
 				if(bitpos > bpos){
 					escape = TRUE;
 					break;
 				}
+			}
+			
+			if(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				invalid_flag = TRUE;
+			}
+			
+			if(byte == AGMV_FILL_FLAG){
+				index = bitstream_data[bitpos++];
 				
-				byte = bitstream_data[bitpos++];
+				if(two_palettes && (index & 0x7f) == 127){
+					bitpos++;
+				}
 				
-				while(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
-					byte = bitstream_data[bitpos++];
+				if(bitpos > bpos){
+					escape = TRUE;
+				}
+			}
+			else if(byte == AGMV_COPY_FLAG){
+				copied = TRUE;
+			}
+			else{
+				for(i = 0; i < 16; i++){
+					index = bitstream_data[bitpos++];
+					
+					if(two_palettes && (index & 0x7f) == 127){
+						bitpos++;
+					}
 					
-					if(bitpos > bpos){
+					if(bitpos > bpos || invalid_flag == TRUE){
 						escape = TRUE;
 						break;
 					}
 				}
+			}
+		}
+	}
+	
+	return escape != TRUE && copied != TRUE;
+}
+
+static void AGMV_RenderStripe(void* data, u32 index){
+	const AGMV_RENDER_JOB* job = (const AGMV_RENDER_JOB*)data;
+	u32 row = index*job->rows_per_task, end_row = row + job->rows_per_task;
+	
+	if(end_row > job->num_of_rows){
+		end_row = job->num_of_rows;
+	}
+	
+	if(row < end_row){
+		AGMV_RenderRows(job,row,end_row,job->row_offsets[row]);
+	}
+}
+
+Bool AGMV_RenderFrame(AGMV* agmv, const u8* bitstream_data, u32 bpos, u8* dest, u32 stride, u32 bpp, const u32* palette0, const u32* palette1, const u8* iframe, u32 iframe_stride){
+	AGMV_RENDER_JOB job;
+	u32 tasks, color;
+	Bool complete;
+	int i;
+	
+	job.agmv = agmv;
+	job.bitstream_data = bitstream_data;
+	job.bpos = bpos;
+	job.dest = dest;
+	job.stride = stride;
+	job.bpp = bpp;
+	job.palette0 = palette0;
+	job.palette1 = palette1;
+	job.iframe = iframe;
+	job.iframe_stride = iframe_stride;
+	job.num_of_rows = (agmv->frame->height + 3) / 4;
+	job.kernels = AGMV_GetBlockKernels();
+	job.two_palettes = agmv->header.version == 1 || agmv->header.version == 3;
+	job.dirty = NULL;
+	
+	if(agmv->track_dirty == TRUE){
+		agmv->dirty = (u8*)realloc(agmv->dirty,job.num_of_rows*((agmv->frame->width+3)/4));
+		memset(agmv->dirty,0,job.num_of_rows*((agmv->frame->width+3)/4));
+		job.dirty = agmv->dirty;
+	}
+	
+	for(i = 0; i < 256; i++){
+		if(job.two_palettes){
+			color = (i & 0x80) ? palette1[i & 0x7f] : palette0[i & 0x7f];
+		}
+		else{
+			color = palette0[i];
+		}
+		AGMV_PutPixel(job.lut + i*bpp,bpp,color);
+	}
+	
+	if(agmv->pool == NULL || agmv->pool->num_of_threads <= 1 || job.num_of_rows < 2){
+		return AGMV_RenderRows(&job,0,job.num_of_rows,0);
+	}
+	
+	/* BLOCKS ONLY READ FROM THE I-FRAME AND WRITE DISJOINT 4X4 REGIONS, SO ONCE EVERY ROW'S STARTING OFFSET IS KNOWN
+	   THE ROWS CAN BE RENDERED IN ANY ORDER. SPLIT THEM INTO A FEW STRIPES PER THREAD FOR LOAD BALANCING */
+	agmv->row_offsets = (u32*)realloc(agmv->row_offsets,sizeof(u32)*job.num_of_rows);
+	complete = AGMV_ScanRows(&job,agmv->row_offsets);
+	
+	tasks = agmv->pool->num_of_threads * 2;
+	
+	if(tasks > job.num_of_rows){
+		tasks = job.num_of_rows;
+	}
+	
+	job.row_offsets = agmv->row_offsets;
+	job.rows_per_task = (job.num_of_rows + tasks - 1) / tasks;
+	
+	AGMV_ThreadPoolRun(agmv->pool,AGMV_RenderStripe,&job,(job.num_of_rows + job.rows_per_task - 1) / job.rows_per_task);
+	
+	return complete;
+}
+
+/* TRUE IF AGMV_RenderFrame WOULD DRAW EVERY BLOCK OF THIS BITSTREAM WITHOUT COPYING FROM THE I-FRAME, WITHOUT DRAWING ANYTHING */
+Bool AGMV_IsFrameComplete(AGMV* agmv, const u8* bitstream_data, u32 bpos){
+	AGMV_RENDER_JOB job;
+	
+	job.agmv = agmv;
+	job.bitstream_data = bitstream_data;
+	job.bpos = bpos;
+	job.num_of_rows = (agmv->frame->height + 3) / 4;
+	job.two_palettes = agmv->header.version == 1 || agmv->header.version == 3;
+	
+	return AGMV_ScanRows(&job,NULL);
+}
+
+/* PARSES THE BITSTREAM EXACTLY LIKE AGMV_RenderRows BUT WRITES ONE PIXEL PER 4X4 BLOCK: THE FILL COLOR, THE TOP LEFT
+   INDEX OF A NORMAL BLOCK, OR THE I-FRAME PREVIEW'S PIXEL FOR A COPY BLOCK */
+static void AGMV_RenderPreview(AGMV* agmv, const u8* bitstream_data, u32 bpos, u32* preview, const u32* ipreview){
+	const u32* palette0 = agmv->header.palette0, *palette1 = agmv->header.palette1, *palette;
+	u32 width = agmv->frame->width, height = agmv->frame->height, pwidth = (width+3)/4, bitpos = 0, color, x, y, i;
+	u8 byte, index, fbit, bot;
+	Bool escape = FALSE, invalid_flag = FALSE;
+	Bool two_palettes = agmv->header.version == 1 || agmv->header.version == 3;
+	
+	for(y = 0; y < height && escape != TRUE; y += 4){
+		for(x = 0; x < width && escape != TRUE; x += 4){
+			
+			if(bitpos > bpos){
+				escape = TRUE;
+				break;
+			}
+			
+			byte = bitstream_data[bitpos++];
+			
+			while(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				byte = bitstream_data[bitpos++];
 				
-				if(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
-					invalid_flag = TRUE;
+				if(bitpos > bpos){
+					escape = TRUE;
+					break;
 				}
+			}
+			
+			if(byte != AGMV_FILL_FLAG && byte != AGMV_NORMAL_FLAG && byte != AGMV_COPY_FLAG){
+				invalid_flag = TRUE;
+			}
+			
+			if(byte == AGMV_COPY_FLAG){
+				preview[x/4 + (y/4)*pwidth] = ipreview[x/4 + (y/4)*pwidth];
+				continue;
+			}
+			
+			for(i = 0; i < (byte == AGMV_FILL_FLAG ? 1 : 16); i++){
+				index = bitstream_data[bitpos++];
 				
-				if(byte == AGMV_FILL_FLAG){
-					index = bitstream_data[bitpos++];
-					color = palette0[index];
-
-					if(x == width-4 && y == height-4){
-						color = img_data[(x-1)+(y+1)*width];
-					}
+				if(two_palettes){
+					fbit = (index >> 7) & 1;
+					bot = (index & 0x7f);
 					
-					if(bitpos > bpos){
-						escape = TRUE;
-						break;
-					}
+					palette = fbit ? palette1 : palette0;
 					
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							img_data[(x+i)+offset] = color;
-						}
+					if(bot < 127){
+						color = palette[bot];
 					}
-				}
-				else if(byte == AGMV_COPY_FLAG){
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							indice = (x+i)+offset;
-							img_data[indice] = iframe_data[indice];
-						}
+					else{
+						index = bitstream_data[bitpos++];
+						color = palette[index];
 					}
 				}
 				else{
-					int i,j;
-					for(j = 0; j < 4; j++){
-						offset = (y+j)*width;
-						for(i = 0; i < 4; i++){
-							index = bitstream_data[bitpos++];
-							if(bitpos > bpos || invalid_flag == TRUE){
-								escape = TRUE;
-								invalid_flag = FALSE;
-								break;
-							}
-							color = palette0[index];
-							img_data[(x+i)+offset] = color;
-						}
+					color = palette0[index];
+				}
+				
+				if(bitpos > bpos || (invalid_flag == TRUE && byte != AGMV_FILL_FLAG)){
+					escape = TRUE;
+					invalid_flag = FALSE;
+					break;
+				}
+				
+				if(i == 0){
+					/* THE FULL SIZE DECODER FILLS THE LAST BLOCK FROM ITS LEFT NEIGHBOR */
+					if(byte == AGMV_FILL_FLAG && x == width-4 && y == height-4 && x > 0){
+						color = preview[x/4 - 1 + (y/4)*pwidth];
 					}
+					
+					preview[x/4 + (y/4)*pwidth] = color;
 				}
 			}
 		}
 	}
+}
+
+int AGMV_DecodeFramePayload(AGMV* agmv, const u8* payload, u32 csize){
+	u32 size = agmv->header.width * agmv->header.height, stride = agmv->frame->width * sizeof(u32), bpos;
+	u32* img_data = agmv->frame->img_data, *iframe_data = agmv->iframe->img_data;
+	
+	bpos = AGMV_DecompressFrame(agmv,payload,csize);
+	
+	AGMV_RenderFrame(agmv,agmv->bitstream->data,bpos,(u8*)img_data,stride,sizeof(u32),agmv->header.palette0,agmv->header.palette1,(const u8*)iframe_data,stride);
 	
 	if(agmv->frame_count % 4 == 0){
-		for(i = 0; i < size; i++){
-			iframe_data[i] = img_data[i];
+		memcpy(iframe_data,img_data,sizeof(u32)*size);
+	}
+	
+	agmv->frame_count++;
+
+	return NO_ERR;
+}
+
+int AGMV_DecodeFramePayloadToCanvas(AGMV* agmv, AGMV_CANVAS* canvas, const u8* payload, u32 csize, void* pixels, u32 stride){
+	u32 bpos, bpp = canvas->bpp, row = canvas->width * bpp, y;
+	u8* dest = (u8*)pixels;
+	
+	bpos = AGMV_DecompressFrame(agmv,payload,csize);
+	
+	AGMV_RenderFrame(agmv,agmv->bitstream->data,bpos,dest,stride,bpp,canvas->palette0,canvas->palette1,canvas->iframe,row);
+	
+	if(agmv->frame_count % 4 == 0){
+		for(y = 0; y < canvas->height; y++){
+			memcpy(canvas->iframe + y*row,dest + y*stride,row);
 		}
 	}
 	
 	agmv->frame_count++;
+	
+	return NO_ERR;
+}
 
+/* DECODES AT 1/4 SCALE INTO PREVIEW, ((WIDTH+3)/4) * ((HEIGHT+3)/4) PIXELS HOLDING THE PREVIOUS PREVIEW. LZ EXPANSION
+   STILL RUNS IN FULL BUT ONLY ONE PIXEL PER BLOCK IS RECONSTRUCTED */
+int AGMV_DecodeFramePayloadPreview(AGMV* agmv, const u8* payload, u32 csize, u32* preview){
+	u32 bpos, size = ((agmv->frame->width+3)/4) * ((agmv->frame->height+3)/4);
+	
+	if(agmv->preview_iframe == NULL){
+		agmv->preview_iframe = (u32*)calloc(size,sizeof(u32));
+	}
+	
+	bpos = AGMV_DecompressFrame(agmv,payload,csize);
+	
+	AGMV_RenderPreview(agmv,agmv->bitstream->data,bpos,preview,agmv->preview_iframe);
+	
+	if(agmv->frame_count % 4 == 0){
+		memcpy(agmv->preview_iframe,preview,sizeof(u32)*size);
+	}
+	
+	agmv->frame_count++;
+	
 	return NO_ERR;
 }
 
+int AGMV_DecodeFrameChunkPreview(FILE* file, AGMV* agmv, u32* preview){
+	u32 csize;
+	int err = AGMV_ReadFrameChunk(file,agmv,&csize);
+	
+	if(err != NO_ERR){
+		return err;
+	}
+	
+	return AGMV_DecodeFramePayloadPreview(agmv,agmv->payload->data,csize,preview);
+}
+
 int AGMV_DecodeAudioChunk(FILE* file, AGMV* agmv){
-	int i;
-	u32 size, start_point;
-	u16 sample, resample, *pcm = agmv->audio_track->pcm, bits_per_sample = AGMV_GetBitsPerSample(agmv);
-	u8* pcm8 = agmv->audio_track->pcm8;
+	u32 size, read;
+	u8* payload;
 	
 	AGMV_ReadFourCC(file,agmv->audio_chunk->fourcc);
 	agmv->audio_chunk->size = AGIDL_ReadLong(file);
@@ -423,12 +916,27 @@ int AGMV_DecodeAudioChunk(FILE* file, AGMV* agmv){
 	}
 	
 	size = agmv->audio_chunk->size;
-	start_point = agmv->audio_track->start_point;
 	
+	payload = AGMV_ResizeBitstream(agmv->payload,size + 1);
+	read = fread(payload,1,size,file);
+	
+	/* samples past the end of a truncated file read back as EOF (0xFF) */
+	for(; read < size; read++){
+		payload[read] = 0xFF;
+	}
+	
+	return AGMV_DecodeAudioPayload(agmv,payload,size);
+}
+
+/* EXPANDS SIZE BYTES OF AN AUDIO CHUNK INTO CONSECUTIVE SAMPLES AT DEST */
+static void AGMV_DecodeAudioSamples(const u8* payload, u32 size, u16 bits_per_sample, void* dest){
+	int i;
+	u16 sample, resample, *pcm = (u16*)dest;
+	u8* pcm8 = (u8*)dest;
 	
 	if(bits_per_sample == 16){
 		for(i = 0; i < size; i++){
-			sample = AGIDL_ReadByte(file);
+			sample = payload[i];
 			resample = 0;
 			
 			if(sample % 2 == 0){
@@ -438,43 +946,419 @@ int AGMV_DecodeAudioChunk(FILE* file, AGMV* agmv){
 				resample = AGMV_SHIFT_TABLE[sample];
 			}
 			
-			pcm[start_point++] = resample; 
+			pcm[i] = resample; 
 		}
 	}
 	else{
-		for(i = 0; i < size; i++){
-			pcm8[start_point++] = AGIDL_ReadByte(file); 
-		}
+		memcpy(pcm8,payload,size);
+	}
+}
+
+int AGMV_DecodeAudioPayload(AGMV* agmv, const u8* payload, u32 size){
+	u32 start_point = agmv->audio_track->start_point;
+	u16 bits_per_sample = AGMV_GetBitsPerSample(agmv);
+	
+	if(bits_per_sample == 16){
+		AGMV_DecodeAudioSamples(payload,size,bits_per_sample,agmv->audio_track->pcm + start_point);
+	}
+	else{
+		AGMV_DecodeAudioSamples(payload,size,bits_per_sample,agmv->audio_track->pcm8 + start_point);
 	}
 	
-	agmv->audio_track->start_point = start_point;
+	agmv->audio_track->start_point = start_point + size;
 	
 	return NO_ERR;
 }
 
-int AGMV_DecodeVideo(const char* filename, u8 img_type){
+/* DECODES ONE CHUNK'S SAMPLES INTO THE RING RATHER THAN THE WHOLE TRACK BUFFER. A CHUNK IS NEVER SPLIT, SO IF THE RING
+   CANNOT HOLD ALL OF IT NOTHING IS WRITTEN AND BUFFER_FULL_ERR IS RETURNED */
+int AGMV_DecodeAudioPayloadToRing(AGMV* agmv, const u8* payload, u32 size, AGMV_AUDIO_RING* ring, u32* num_of_samples){
+	u32 head = ring->head, bytes = ring->bits_per_sample/8, start, first;
 	
-	int err, err1, i, num_of_frames;
+	if(num_of_samples != NULL){
+		*num_of_samples = 0;
+	}
+	
+	if(ring->bits_per_sample != (AGMV_GetBitsPerSample(agmv) == 16 ? 16 : 8)){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	if(size > ring->capacity - (head - AGMV_AtomicLoad(&ring->tail))){
+		return BUFFER_FULL_ERR;
+	}
+	
+	start = head % ring->capacity;
+	first = ring->capacity - start;
+	
+	if(first > size){
+		first = size;
+	}
+	
+	AGMV_DecodeAudioSamples(payload,first,ring->bits_per_sample,ring->data + start*bytes);
+	AGMV_DecodeAudioSamples(payload + first,size - first,ring->bits_per_sample,ring->data);
+	
+	AGMV_AtomicStore(&ring->head,head+size);
+	
+	if(num_of_samples != NULL){
+		*num_of_samples = size;
+	}
+	
+	return NO_ERR;
+}
+
+/* ON BUFFER_FULL_ERR THE FILE IS LEFT AT THE START OF THE CHUNK, SO THE CALLER CAN DRAIN THE RING AND TRY AGAIN. IF THE RING
+   IS ALREADY EMPTY IT IS TOO SMALL, AGMV->AUDIO_CHUNK->SIZE THEN HOLDS THE NUMBER OF SAMPLES IT MUST HAVE ROOM FOR */
+int AGMV_DecodeAudioChunkToRing(FILE* file, AGMV* agmv, AGMV_AUDIO_RING* ring, u32* num_of_samples){
+	u32 size, read, pos = ftell(file);
+	u8* payload;
+	
+	if(num_of_samples != NULL){
+		*num_of_samples = 0;
+	}
+	
+	AGMV_ReadFourCC(file,agmv->audio_chunk->fourcc);
+	agmv->audio_chunk->size = AGIDL_ReadLong(file);
+	
+	if(!AGMV_IsCorrectFourCC(agmv->audio_chunk->fourcc,'A','G','A','C')){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	size = agmv->audio_chunk->size;
+	
+	if(size > AGMV_GetAudioRingSpace(ring)){
+		fseek(file,pos,SEEK_SET);
+		return BUFFER_FULL_ERR;
+	}
+	
+	payload = AGMV_ResizeBitstream(agmv->payload,size + 1);
+	read = fread(payload,1,size,file);
+	
+	/* samples past the end of a truncated file read back as EOF (0xFF) */
+	for(; read < size; read++){
+		payload[read] = 0xFF;
+	}
+	
+	return AGMV_DecodeAudioPayloadToRing(agmv,payload,size,ring,num_of_samples);
+}
+
+/* STREAMS A WHOLE FILE EXPORT OF THE AUDIO TRACK ONE CHUNK AT A TIME THROUGH A SMALL RING, SO MEMORY USE DOES NOT GROW WITH
+   THE LENGTH OF THE VIDEO. THE CONTAINER HEADER PROMISES AUDIO_SIZE SAMPLES, SO EXACTLY THAT MANY ARE WRITTEN */
+typedef struct AGMV_AUDIO_EXPORT{
+	FILE* audio;
+	const char* filename;
+	AGMV_AUDIO_TYPE audio_type;
+	AGMV_AUDIO_RING* ring;
+	u8* samples;
+	u32 remaining;
+}AGMV_AUDIO_EXPORT;
+
+static void AGMV_OpenAudioExport(AGMV_AUDIO_EXPORT* track, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
+	u32 capacity = agmv->header.num_of_frames != 0 ? agmv->header.audio_size / agmv->header.num_of_frames : 0;
+	
+	switch(audio_type){
+		case AGMV_AUDIO_AIFC:
+		case AGMV_AUDIO_AIFF:{
+			track->filename = "quick_export.aiff";
+		}break;
+		default:{
+			track->filename = "quick_export.wav";
+			audio_type = AGMV_AUDIO_WAV;
+		}break;
+	}
+	
+	/* ROOM FOR TWO AVERAGE CHUNKS, IT GROWS IF A SINGLE CHUNK TURNS OUT LARGER */
+	track->audio_type = audio_type;
+	track->ring = AGMV_CreateAudioRing(capacity*2 + 1,AGMV_GetBitsPerSample(agmv));
+	track->samples = (u8*)malloc(track->ring->capacity*2);
+	track->remaining = agmv->header.audio_size;
+	track->audio = fopen(track->filename,"wb");
+	
+	if(track->audio != NULL){
+		AGMV_ExportAudioHeader(track->audio,agmv,audio_type);
+	}
+}
+
+static int AGMV_ExportMappedAudioChunk(AGMV_MAPPED_FILE* file, AGMV* agmv, AGMV_AUDIO_EXPORT* track){
+	u32 num_of_samples;
+	int err = AGMV_DecodeMappedAudioChunkToRing(file,agmv,track->ring,&num_of_samples);
+	
+	if(err == BUFFER_FULL_ERR){
+		AGMV_DestroyAudioRing(track->ring);
+		track->ring = AGMV_CreateAudioRing(agmv->audio_chunk->size,AGMV_GetBitsPerSample(agmv));
+		track->samples = (u8*)realloc(track->samples,track->ring->capacity*2);
+		err = AGMV_DecodeMappedAudioChunkToRing(file,agmv,track->ring,&num_of_samples);
+	}
+	
+	if(err != NO_ERR){
+		return err;
+	}
+	
+	AGMV_ReadAudioRing(track->ring,track->samples,num_of_samples);
+	
+	if(num_of_samples > track->remaining){
+		num_of_samples = track->remaining;
+	}
+	
+	if(track->audio != NULL){
+		AGMV_ExportAudioSamples(track->audio,agmv,track->audio_type,track->samples,num_of_samples);
+	}
+	
+	track->remaining -= num_of_samples;
+	
+	return NO_ERR;
+}
+
+/* A FAILED EXPORT IS REMOVED, AS NOTHING WAS EVER WRITTEN BEFORE THE TRACK WAS DECODED IN FULL. A SHORT TRACK IS PADDED WITH
+   ZERO BYTES, WHICH IS WHAT THE UNFILLED END OF THE OLD WHOLE TRACK BUFFER HELD IN PRACTICE */
+static void AGMV_CloseAudioExport(AGMV_AUDIO_EXPORT* track, AGMV* agmv, Bool keep){
+	u32 count;
+	
+	if(track->audio != NULL){
+		if(keep == TRUE){
+			memset(track->samples,0,track->ring->capacity*2);
+			
+			while(track->remaining > 0){
+				count = track->remaining < track->ring->capacity ? track->remaining : track->ring->capacity;
+				AGMV_ExportAudioSamples(track->audio,agmv,track->audio_type,track->samples,count);
+				track->remaining -= count;
+			}
+		}
+		
+		fclose(track->audio);
+		
+		if(keep != TRUE){
+			remove(track->filename);
+		}
+	}
+	
+	AGMV_DestroyAudioRing(track->ring);
+	free(track->samples);
+}
+
+typedef struct AGMV_GOP_JOB{
+	AGMV** contexts;
+	const u8** payloads;
+	u32* csizes;
+	u32* usizes;
+	AGMV_BITSTREAM* bitstreams; /* 4 DECOMPRESSED FRAMES PER GOP IN THE BATCH */
+	u32** frames;               /* 4 OUTPUT FRAMES PER GOP IN THE BATCH */
+	Bool* self_contained;       /* TRUE IF THE GOP'S I-FRAME DID NOT DEPEND ON THE PREVIOUS GOP */
+	u32 first_gop;
+	u32 num_of_frames;
+}AGMV_GOP_JOB;
+
+/* DECODES ONE GROUP OF AN I-FRAME AND ITS THREE P-FRAMES WITH A PRIVATE CONTEXT. EACH FRAME STARTS FROM A COPY OF THE ONE
+   BEFORE IT, JUST LIKE THE SERIAL DECODER RENDERING OVER ITS OWN LAST FRAME, AND COPY BLOCKS READ THE GOP'S OWN I-FRAME */
+static void AGMV_DecodeGOP(void* data, u32 index){
+	AGMV_GOP_JOB* job = (AGMV_GOP_JOB*)data;
+	AGMV* ctx = job->contexts[index];
+	AGMV_BITSTREAM* bitstream;
+	u32 gop = job->first_gop + index, frame = gop*4, stride = ctx->frame->width*sizeof(u32), k;
+	u32** out = job->frames + index*4;
+	Bool complete;
+	
+	for(k = 0; k < 4 && frame + k < job->num_of_frames; k++){
+		bitstream = &job->bitstreams[index*4+k];
+		
+		/* DECOMPRESS STRAIGHT INTO THIS FRAME'S SLOT SO A FALLBACK RERENDER CAN REUSE IT */
+		*ctx->bitstream = *bitstream;
+		ctx->frame_chunk->uncompressed_size = job->usizes[frame+k];
+		AGMV_DecompressFrame(ctx,job->payloads[frame+k],job->csizes[frame+k]);
+		*bitstream = *ctx->bitstream;
+		
+		if(k > 0){
+			memcpy(out[k],out[k-1],stride*ctx->frame->height);
+		}
+		
+		complete = AGMV_RenderFrame(ctx,bitstream->data,bitstream->pos,(u8*)out[k],stride,sizeof(u32),ctx->header.palette0,ctx->header.palette1,(const u8*)out[0],stride);
+		
+		if(k == 0){
+			job->self_contained[index] = complete;
+		}
+	}
+}
+
+static int AGMV_DecodeMappedFrames(AGMV_MAPPED_FILE* file, AGMV* agmv, u32 num_of_frames, Bool has_audio, AGMV_AUDIO_EXPORT* audio, u8 img_type, Bool* audio_err, u32 num_of_threads){
+	AGMV_THREAD_POOL* pool;
+	AGMV_EXPORTER* exporter;
+	AGMV_GOP_JOB job;
+	u32 width = agmv->frame->width, height = agmv->frame->height, size = width*height, frame_bytes = sizeof(u32)*size;
+	u32 num_of_gops, batch, depth, first, count, valid_frames = 0, i, k, frame;
+	int err = NO_ERR, err1, err2;
+	
+	if(num_of_threads == 0){
+		num_of_threads = AGMV_GetNumberOfCores();
+	}
+	
+	if(audio_err != NULL){
+		*audio_err = FALSE;
+	}
+	
+	job.payloads = (const u8**)malloc(sizeof(u8*)*(num_of_frames+1));
+	job.csizes = (u32*)malloc(sizeof(u32)*(num_of_frames+1));
+	job.usizes = (u32*)malloc(sizeof(u32)*(num_of_frames+1));
+	
+	for(i = 0; i < num_of_frames; i++){
+		AGMV_MappedFindNextFrameChunk(file);
+		err1 = AGMV_ReadMappedFrameChunk(file,agmv,&job.payloads[i],&job.csizes[i]);
+		job.usizes[i] = agmv->frame_chunk->uncompressed_size;
+		err2 = NO_ERR;
+		
+		if(has_audio == TRUE){
+			AGMV_MappedFindNextAudioChunk(file);
+			
+			if(audio != NULL){
+				err2 = AGMV_ExportMappedAudioChunk(file,agmv,audio);
+			}
+			else{
+				AGMV_MappedSkipAudioChunk(file);
+			}
+		}
+		
+		if(err1 != NO_ERR){
+			err = err1;
+			break;
+		}
+		
+		if(err2 != NO_ERR){
+			if(audio_err != NULL){
+				*audio_err = TRUE;
+			}
+			break;
+		}
+		
+		valid_frames++;
+	}
+	
+	num_of_gops = (valid_frames + 3) / 4;
+	
+	/* KEEP A BATCH'S FRAMES UNDER ROUGHLY 256MB */
+	batch = num_of_threads * 2;
+	
+	if(batch * 4 * frame_bytes > 256*1024*1024){
+		batch = (256*1024*1024) / (4 * frame_bytes);
+	}
+	
+	if(batch < 1){
+		batch = 1;
+	}
+	
+	if(batch > num_of_gops){
+		batch = num_of_gops;
+	}
+	
+	pool = num_of_threads > 1 && batch > 1 ? AGMV_CreateThreadPool(num_of_threads) : NULL;
+	
+	/* DISK WRITES OVERLAP THE NEXT BATCH'S DECODE. THE QUEUE HOLDS ONE BATCH OF FRAME COPIES, KEPT UNDER ROUGHLY 64MB */
+	depth = batch * 4;
+	
+	if(depth * frame_bytes > 64*1024*1024){
+		depth = (64*1024*1024) / frame_bytes;
+	}
+	
+	exporter = AGMV_CreateExporter(width,height,img_type,num_of_threads,depth);
+	
+	job.contexts = (AGMV**)malloc(sizeof(AGMV*)*batch);
+	job.bitstreams = (AGMV_BITSTREAM*)calloc(batch*4,sizeof(AGMV_BITSTREAM));
+	job.frames = (u32**)malloc(sizeof(u32*)*batch*4);
+	job.self_contained = (Bool*)malloc(sizeof(Bool)*batch);
+	job.num_of_frames = valid_frames;
+	
+	for(i = 0; i < batch; i++){
+		job.contexts[i] = AGMV_AllocDecoder();
+		job.contexts[i]->header = agmv->header;
+		job.contexts[i]->frame->width = width;
+		job.contexts[i]->frame->height = height;
+	}
+	
+	for(i = 0; i < batch*4; i++){
+		job.frames[i] = (u32*)malloc(frame_bytes);
+		AGMV_ResizeBitstream(&job.bitstreams[i],size*2);
+	}
+	
+	for(first = 0; first < num_of_gops; first += batch){
+		count = num_of_gops - first < batch ? num_of_gops - first : batch;
+		job.first_gop = first;
+		
+		AGMV_ThreadPoolRun(pool,AGMV_DecodeGOP,&job,count);
+		
+		for(i = 0; i < count; i++){
+			frame = (first + i)*4;
+			
+			if(job.self_contained[i] == TRUE){
+				for(k = 0; k < 4 && frame + k < valid_frames; k++){
+					AGMV_ExportFrame(exporter,job.frames[i*4+k]);
+				}
+				
+				memcpy(agmv->frame->img_data,job.frames[i*4+k-1],frame_bytes);
+				memcpy(agmv->iframe->img_data,job.frames[i*4],frame_bytes);
+				agmv->frame_count = frame + k;
+			}
+			else{
+				/* THE BITSTREAMS ARE ALREADY DECOMPRESSED, SO ONLY RERENDER ON TOP OF THE PREVIOUS GOP, SPLITTING ROWS ACROSS THE IDLE POOL */
+				agmv->pool = pool;
+				
+				for(k = 0; k < 4 && frame + k < valid_frames; k++){
+					AGMV_BITSTREAM* bitstream = &job.bitstreams[i*4+k];
+					AGMV_RenderFrame(agmv,bitstream->data,bitstream->pos,(u8*)agmv->frame->img_data,width*sizeof(u32),sizeof(u32),agmv->header.palette0,agmv->header.palette1,(const u8*)agmv->iframe->img_data,width*sizeof(u32));
+					
+					if(k == 0){
+						memcpy(agmv->iframe->img_data,agmv->frame->img_data,frame_bytes);
+					}
+					
+					AGMV_ExportFrame(exporter,agmv->frame->img_data);
+				}
+				
+				agmv->pool = NULL;
+				agmv->frame_count = frame + k;
+			}
+		}
+	}
+	
+	AGMV_DestroyExporter(exporter);
+	
+	for(i = 0; i < batch; i++){
+		/* THE CONTEXT ONLY BORROWED THE JOB'S BITSTREAM BUFFERS */
+		job.contexts[i]->bitstream->data = NULL;
+		DestroyAGMV(job.contexts[i]);
+	}
+	
+	for(i = 0; i < batch*4; i++){
+		free(job.frames[i]);
+		free(job.bitstreams[i].data);
+	}
+	
+	AGMV_DestroyThreadPool(pool);
+	free(job.contexts);
+	free(job.bitstreams);
+	free(job.frames);
+	free(job.self_contained);
+	free(job.payloads);
+	free(job.csizes);
+	free(job.usizes);
+	
+	return err;
+}
+
+int AGMV_DecodeVideo(const char* filename, u8 img_type){
+	return AGMV_DecodeVideoThreads(filename,img_type,0);
+}
+
+/* NUM_OF_THREADS DECODES GOPS AND WRITES FRAMES ON THAT MANY THREADS, 0 USES ONE PER CORE */
+int AGMV_DecodeVideoThreads(const char* filename, u8 img_type, u32 num_of_threads){
+	int err, err1, num_of_frames;
 	Bool has_audio = FALSE;
 	
-	AGMV* agmv = (AGMV*)malloc(sizeof(AGMV));
-	agmv->frame_chunk = (AGMV_FRAME_CHUNK*)malloc(sizeof(AGMV_FRAME_CHUNK));
-	agmv->audio_chunk = (AGMV_AUDIO_CHUNK*)malloc(sizeof(AGMV_AUDIO_CHUNK));
-	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
-	agmv->bitstream->pos = 0;
-	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
+	AGMV* agmv = AGMV_AllocDecoder();
 	
-	FILE* file = fopen(filename,"rb");
+	AGMV_MAPPED_FILE* file = AGMV_OpenMapped(filename);
 	
 	if(file == NULL){
-		fclose(file);
 		DestroyAGMV(agmv);
 		return FILE_NOT_FOUND_ERR;
 	}
 	
-	err = AGMV_DecodeHeader(file,agmv);
+	err = AGMV_DecodeMappedHeader(file,agmv);
 	
 	if(agmv->header.total_audio_duration != 0){
 		has_audio = TRUE;
@@ -482,11 +1366,11 @@ int AGMV_DecodeVideo(const char* filename, u8 img_type){
 	
 	agmv->frame->width = agmv->header.width;
 	agmv->frame->height = agmv->header.height;
-	agmv->frame->img_data = (u32*)malloc(sizeof(u32)*agmv->frame->width*agmv->frame->height);
+	agmv->frame->img_data = (u32*)calloc(agmv->frame->width*agmv->frame->height,sizeof(u32));
 	
 	agmv->iframe->width = agmv->header.width;
 	agmv->iframe->height = agmv->header.height;
-	agmv->iframe->img_data = (u32*)malloc(sizeof(u32)*agmv->frame->width*agmv->frame->height);
+	agmv->iframe->img_data = (u32*)calloc(agmv->frame->width*agmv->frame->height,sizeof(u32));
 	
 	agmv->bitstream->len = agmv->header.width*agmv->header.height*2;
 	agmv->bitstream->data = (u8*)malloc(sizeof(u8)*agmv->bitstream->len);
@@ -494,153 +1378,95 @@ int AGMV_DecodeVideo(const char* filename, u8 img_type){
 	num_of_frames = AGMV_GetNumberOfFrames(agmv);
 	
 	if(err != NO_ERR){
-		fclose(file);
+		AGMV_CloseMapped(file);
 		DestroyAGMV(agmv);
 		return err;
 	}
 	else{
-		for(i = 0; i < num_of_frames; i++){
-			AGMV_FindNextFrameChunk(file);
-			err1 = AGMV_DecodeFrameChunk(file,agmv);
-			
-			if(has_audio == TRUE){
-				AGMV_FindNextAudioChunk(file);
-				AGMV_SkipAudioChunk(file);
-			}
-				
-			if(err1 != NO_ERR){
-				fclose(file);
-				DestroyAGMV(agmv);
-				return err1;
-			}
-			
-			AGIDL_QuickExport(agmv->frame->img_data,agmv->frame->width,agmv->frame->height,AGIDL_RGB_888,img_type);
+		err1 = AGMV_DecodeMappedFrames(file,agmv,num_of_frames,has_audio,NULL,img_type,NULL,num_of_threads);
+		
+		if(err1 != NO_ERR){
+			AGMV_CloseMapped(file);
+			DestroyAGMV(agmv);
+			return err1;
 		}
 	}
 	
-	fclose(file);
+	AGMV_CloseMapped(file);
 	DestroyAGMV(agmv);
 	
 	return NO_ERR;
 }
 
 int AGMV_DecodeAGMV(const char* filename, u8 img_type, AGMV_AUDIO_TYPE audio_type){
-	FILE* file, *audio;
-	int err, err1, err2, i, num_of_frames;
-	u16 bits_per_sample;
+	return AGMV_DecodeAGMVThreads(filename,img_type,audio_type,0);
+}
+
+/* NUM_OF_THREADS DECODES GOPS AND WRITES FRAMES ON THAT MANY THREADS, 0 USES ONE PER CORE */
+int AGMV_DecodeAGMVThreads(const char* filename, u8 img_type, AGMV_AUDIO_TYPE audio_type, u32 num_of_threads){
+	AGMV_MAPPED_FILE* file;
+	AGMV_AUDIO_EXPORT track;
+	int err, err1, num_of_frames;
+	Bool audio_err;
 	
-	AGMV* agmv = (AGMV*)malloc(sizeof(AGMV));
-	agmv->frame_chunk = (AGMV_FRAME_CHUNK*)malloc(sizeof(AGMV_FRAME_CHUNK));
-	agmv->audio_chunk = (AGMV_AUDIO_CHUNK*)malloc(sizeof(AGMV_AUDIO_CHUNK));
-	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
-	agmv->bitstream->pos = 0;
-	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
+	AGMV* agmv = AGMV_AllocDecoder();
 	
-	file = fopen(filename,"rb");
+	file = AGMV_OpenMapped(filename);
 	
 	if(file == NULL){
-		fclose(file);
 		DestroyAGMV(agmv);
 		return FILE_NOT_FOUND_ERR;
 	}
 	
-	err = AGMV_DecodeHeader(file,agmv);
+	err = AGMV_DecodeMappedHeader(file,agmv);
 	
 	agmv->frame->width = agmv->header.width;
 	agmv->frame->height = agmv->header.height;
-	agmv->frame->img_data = (u32*)malloc(sizeof(u32)*agmv->frame->width*agmv->frame->height);
+	agmv->frame->img_data = (u32*)calloc(agmv->frame->width*agmv->frame->height,sizeof(u32));
 	
 	agmv->iframe->width = agmv->header.width;
 	agmv->iframe->height = agmv->header.height;
-	agmv->iframe->img_data = (u32*)malloc(sizeof(u32)*agmv->frame->width*agmv->frame->height);
+	agmv->iframe->img_data = (u32*)calloc(agmv->frame->width*agmv->frame->height,sizeof(u32));
 	
 	agmv->bitstream->len = agmv->header.width*agmv->header.height*2;
 	agmv->bitstream->data = (u8*)malloc(sizeof(u8)*agmv->bitstream->len);
 	
 	num_of_frames = AGMV_GetNumberOfFrames(agmv);
-	bits_per_sample = AGMV_GetBitsPerSample(agmv);
 	
 	if(err != NO_ERR){
-		fclose(file);
+		AGMV_CloseMapped(file);
 		DestroyAGMV(agmv);
 		return err;
 	}
 	else{
 		if(agmv->header.total_audio_duration != 0){
-			agmv->audio_track->start_point = 0;
-			
-			if(bits_per_sample == 16){
-				agmv->audio_track->pcm = (u16*)malloc(sizeof(u16)*agmv->header.audio_size);
-			}
-			else{
-				agmv->audio_track->pcm8 = (u8*)malloc(sizeof(u8)*agmv->header.audio_size);
-			}
-	
 			agmv->audio_chunk->size = agmv->header.audio_size / (f32)agmv->header.num_of_frames;
 			
-			for(i = 0; i < num_of_frames; i++){
-				AGMV_FindNextFrameChunk(file);
-				err1 = AGMV_DecodeFrameChunk(file,agmv);
-				AGMV_FindNextAudioChunk(file);
-				err2 = AGMV_DecodeAudioChunk(file,agmv);
-				
-				if(err1 != NO_ERR){
-					fclose(file);
-					DestroyAGMV(agmv);
-					return err1;
-				}
-				
-				if(err2 != NO_ERR){
-					fclose(file);
-					DestroyAGMV(agmv);
-					return err1;
-				}
-				
-				AGIDL_QuickExport(agmv->frame->img_data,agmv->frame->width,agmv->frame->height,AGIDL_RGB_888,img_type);
-			}
-
-			switch(audio_type){
-				case AGMV_AUDIO_WAV:{
-					audio = fopen("quick_export.wav","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_WAV);
-					fclose(audio);
-				}break;
-				case AGMV_AUDIO_AIFC:{
-					audio = fopen("quick_export.aiff","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_AIFC);
-					fclose(audio);
-				}break;
-				case AGMV_AUDIO_AIFF:{
-					audio = fopen("quick_export.aiff","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_AIFF);
-					fclose(audio);
-				}break;
-				default:{
-					audio = fopen("quick_export.wav","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_WAV);	
-					fclose(audio);
-				}break;
+			AGMV_OpenAudioExport(&track,agmv,audio_type);
+			
+			err1 = AGMV_DecodeMappedFrames(file,agmv,num_of_frames,TRUE,&track,img_type,&audio_err,num_of_threads);
+			
+			/* AN AUDIO CHUNK ERROR STOPS THE EXPORT WITHOUT REPORTING ONE, AS IT ALWAYS HAS */
+			AGMV_CloseAudioExport(&track,agmv,err1 == NO_ERR && audio_err != TRUE);
+			
+			if(err1 != NO_ERR || audio_err == TRUE){
+				AGMV_CloseMapped(file);
+				DestroyAGMV(agmv);
+				return err1;
 			}
 		}
 		else{
-			for(i = 0; i < num_of_frames; i++){
-				AGMV_FindNextFrameChunk(file);
-				err1 = AGMV_DecodeFrameChunk(file,agmv);
-					
-				if(err1 != NO_ERR){
-					fclose(file);
-					DestroyAGMV(agmv);
-					return err1;
-				}
+			err1 = AGMV_DecodeMappedFrames(file,agmv,num_of_frames,FALSE,NULL,img_type,NULL,num_of_threads);
 				
-				AGIDL_QuickExport(agmv->frame->img_data,agmv->frame->width,agmv->frame->height,AGIDL_RGB_888,img_type);
+			if(err1 != NO_ERR){
+				AGMV_CloseMapped(file);
+				DestroyAGMV(agmv);
+				return err1;
 			}
 		}
 	}
 	
-	fclose(file);
+	AGMV_CloseMapped(file);
 	DestroyAGMV(agmv);
 	
 	return NO_ERR;
@@ -680,87 +1506,52 @@ void to_80bitfloat(u32 num, u8 bytes[10])
 } 
 
 int AGMV_DecodeAudio(const char* filename, AGMV_AUDIO_TYPE audio_type){
-	FILE* file, *audio;
+	AGMV_MAPPED_FILE* file;
+	AGMV_AUDIO_EXPORT track;
 	int err, err1, i, num_of_frames;
-	u16 bits_per_sample;
 	
-	AGMV* agmv = (AGMV*)malloc(sizeof(AGMV));
-	agmv->frame_chunk = (AGMV_FRAME_CHUNK*)malloc(sizeof(AGMV_FRAME_CHUNK));
-	agmv->audio_chunk = (AGMV_AUDIO_CHUNK*)malloc(sizeof(AGMV_AUDIO_CHUNK));
-	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
-	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
+	AGMV* agmv = AGMV_AllocDecoder();
 	
-	file = fopen(filename,"rb");
+	file = AGMV_OpenMapped(filename);
 	
 	if(file == NULL){
-		fclose(file);
 		DestroyAGMV(agmv);
 		return FILE_NOT_FOUND_ERR;
 	}
 	
-	err = AGMV_DecodeHeader(file,agmv);
+	err = AGMV_DecodeMappedHeader(file,agmv);
 	num_of_frames = AGMV_GetNumberOfFrames(agmv);
-	bits_per_sample = AGMV_GetBitsPerSample(agmv);
 	
 	if(err != NO_ERR){
-		fclose(file);
+		AGMV_CloseMapped(file);
 		DestroyAGMV(agmv);
 		return err;
 	}
 	else{
 		if(agmv->header.total_audio_duration != 0){
-			agmv->audio_track->start_point = 0;
-			
-			if(bits_per_sample == 16){
-				agmv->audio_track->pcm = (u16*)malloc(sizeof(u16)*agmv->header.audio_size);
-			}
-			else{
-				agmv->audio_track->pcm8 = (u8*)malloc(sizeof(u8)*agmv->header.audio_size);
-			}
-	
 			agmv->audio_chunk->size = agmv->header.audio_size / (f32)agmv->header.num_of_frames;
 			
+			AGMV_OpenAudioExport(&track,agmv,audio_type);
+			
 			for(i = 0; i < num_of_frames; i++){
-				AGMV_FindNextFrameChunk(file);
-				AGMV_SkipFrameChunk(file);
-				AGMV_FindNextAudioChunk(file);
-				err1 = AGMV_DecodeAudioChunk(file,agmv);
+				AGMV_MappedFindNextFrameChunk(file);
+				AGMV_MappedSkipFrameChunk(file);
+				AGMV_MappedFindNextAudioChunk(file);
+				err1 = AGMV_ExportMappedAudioChunk(file,agmv,&track);
 
 				if(err1 != NO_ERR){
-					fclose(file);
+					AGMV_CloseAudioExport(&track,agmv,FALSE);
+					AGMV_CloseMapped(file);
 					DestroyAGMV(agmv);
 					return err1;
 				}
 			}
 			
-			switch(audio_type){
-				case AGMV_AUDIO_WAV:{
-					audio = fopen("quick_export.wav","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_WAV);
-					fclose(audio);
-				}break;
-				case AGMV_AUDIO_AIFC:{
-					audio = fopen("quick_export.aiff","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_AIFC);
-					fclose(audio);
-				}break;
-				case AGMV_AUDIO_AIFF:{
-					audio = fopen("quick_export.aiff","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_AIFF);
-					fclose(audio);
-				}break;
-				default:{
-					audio = fopen("quick_export.wav","wb");
-					AGMV_ExportAudioType(audio,agmv,AGMV_AUDIO_WAV);	
-					fclose(audio);
-				}break;
-			}
-		}
-	}
-	
-	fclose(file);
+			AGMV_CloseAudioExport(&track,agmv,TRUE);
+		}
+	}
+	
+	AGMV_CloseMapped(file);
 	DestroyAGMV(agmv);
 	
 	return NO_ERR;
@@ -16,7 +16,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <agmv_encode.h>
+#include <agmv_decode.h>
 #include <agmv_utils.h>
+#include <agmv_thread.h>
 
 void AGMV_EncodeHeader(FILE* file, AGMV* agmv){
 	u32 i;
@@ -27,6 +29,8 @@ void AGMV_EncodeHeader(FILE* file, AGMV* agmv){
 	
 	opt = AGMV_GetOPT(agmv);
 	compression = AGMV_GetCompression(agmv);
+	
+	agmv->header.version = AGMV_GetVersionFromOPT(opt,compression);
 
 	AGMV_WriteFourCC(file,'A','G','M','V');
 	AGMV_WriteLong(file,AGMV_GetNumberOfFrames(agmv));
@@ -91,6 +95,10 @@ void AGMV_EncodeHeader(FILE* file, AGMV* agmv){
 			AGMV_WriteByte(file,b);
 		}
 	}
+	
+	/* POINTER TO THE SEEK INDEX, PATCHED BY AGMV_EncodeIndexChunk ONCE ALL FRAMES ARE WRITTEN */
+	AGMV_WriteFourCC(file,'A','G','I','P');
+	AGMV_WriteLong(file,0);
 }
 
 /*
@@ -103,15 +111,101 @@ LZSS
 #define	FRONT_WINDOW	15
 #define	FRONT_BITS		4
 
-u32 AGMV_LZSS (FILE* file, AGMV_BITSTREAM* in)
+#define	HASH_BITS		15
+#define	HASH_SIZE		(1 << HASH_BITS)
+#define	CHAIN_SIZE		65536
+
+/* HASH CHAINS OVER THE BACK WINDOW. HEAD HOLDS THE NEWEST POSITION FOR EACH HASH OF THREE BYTES AND PREV LINKS EVERY
+   POSITION TO THE PREVIOUS ONE WITH THE SAME HASH, SO ONLY CANDIDATES THAT CAN MATCH AT LEAST THREE BYTES ARE VISITED.
+   LZ77 ALSO EMITS ONE AND TWO BYTE MATCHES, WHICH COME FROM THE NEWEST POSITION OF EACH BYTE AND BYTE PAIR */
+typedef struct AGMV_MATCH_FINDER{
+	int head[HASH_SIZE];
+	int prev[CHAIN_SIZE];
+	int last2[65536];
+	int last1[256];
+	int inserted;
+	u32 depth;
+}AGMV_MATCH_FINDER;
+
+static AGMV_MATCH_FINDER* AGMV_CreateMatchFinder(u32 depth){
+	AGMV_MATCH_FINDER* finder = (AGMV_MATCH_FINDER*)malloc(sizeof(AGMV_MATCH_FINDER));
+	finder->depth = depth;
+	memset(finder->head,0xff,sizeof(finder->head));
+	memset(finder->last2,0xff,sizeof(finder->last2));
+	memset(finder->last1,0xff,sizeof(finder->last1));
+	finder->inserted = 0;
+	return finder;
+}
+
+static int AGMV_Hash3(const u8* data){
+	return (int)((((unsigned int)data[0] << 16 | (unsigned int)data[1] << 8 | data[2]) * 2654435761u) >> (32 - HASH_BITS));
+}
+
+/* LINKS EVERY POSITION BEFORE END INTO ITS CHAIN. POSITIONS WITHIN TWO BYTES OF THE END CANNOT START A THREE BYTE MATCH */
+static void AGMV_InsertMatches(AGMV_MATCH_FINDER* finder, const u8* data, int end, int pos){
+	int h;
+	
+	for(; finder->inserted < end; finder->inserted++){
+		if(finder->inserted + 2 < pos){
+			h = AGMV_Hash3(data + finder->inserted);
+			finder->prev[finder->inserted & (CHAIN_SIZE-1)] = finder->head[h];
+			finder->head[h] = finder->inserted;
+		}
+		
+		if(finder->inserted + 1 < pos){
+			finder->last2[data[finder->inserted] << 8 | data[finder->inserted+1]] = finder->inserted;
+		}
+		
+		finder->last1[data[finder->inserted]] = finder->inserted;
+	}
+}
+
+/* RETURNS THE LONGEST MATCH OF UP TO MAX BYTES FOR POSITION I, AT LEAST THREE BYTES LONG OR 0. WITH AN UNLIMITED DEPTH
+   TIES GO TO THE OLDEST CANDIDATE LIKE THE EXHAUSTIVE SEARCH, OTHERWISE TO THE NEWEST AND THE WALK STOPS EARLY */
+static int AGMV_FindMatch(AGMV_MATCH_FINDER* finder, const u8* data, int i, int max, int pos, int window, int* beststart){
+	int start, limit = i - window, j, bestlength = 0;
+	u32 depth = finder->depth, visited = 0;
+	
+	AGMV_InsertMatches(finder,data,i,pos);
+	
+	if(max < 3){
+		return 0;
+	}
+	
+	for(start = finder->head[AGMV_Hash3(data + i)]; start >= 0 && start >= limit; start = finder->prev[start & (CHAIN_SIZE-1)]){
+		for(j = 0; j < max; j++){
+			if(data[start+j] != data[i+j]){
+				break;
+			}
+		}
+		
+		if(j > bestlength || (depth == 0 && j == bestlength && j >= 3)){
+			bestlength = j;
+			*beststart = start;
+		}
+		
+		if(depth != 0 && (bestlength == max || ++visited >= depth)){
+			break;
+		}
+	}
+	
+	return bestlength >= 3 ? bestlength : 0;
+}
+
+/* BOTH COMPRESSORS APPEND TO OUT AND RETURN THE WHOLE BYTES THEY PRODUCED. LZSS MAY LEAVE A PARTIAL BYTE IN OUT->BITBUF.
+   DEPTH IS THE ENCODER'S MATCH SEARCH DEPTH, SEE AGMV_SetMatchDepth */
+u32 AGMV_CompressLZSS(AGMV_BITSTREAM* out, AGMV_BITSTREAM* in, u32 depth)
 {
 	int		i;
 	int		val;
-	int		j, start, max;
+	int		max;
 	int		bestlength, beststart;
 	int		outbits = 0;
 	int     pos = in->pos;
 	u8*     data = in->data;
+	AGMV_MATCH_FINDER* finder = AGMV_CreateMatchFinder(depth);
+
+	AGMV_ReserveBitstream(out,pos + pos/8 + 4);
 
 	outbits = 0;
 	for (i=0 ; i<pos ; )
@@ -122,25 +216,8 @@ u32 AGMV_LZSS (FILE* file, AGMV_BITSTREAM* in)
 		if (i + max > pos)
 			max = pos - i;
 
-		start = i - BACK_WINDOW;
-		if (start < 0)
-			start = 0;
-		bestlength = 0;
 		beststart = 0;
-		for ( ; start < i ; start++)
-		{
-			if (data[start] != val)
-				continue;
-			// count match length
-			for (j=0 ; j<max ; j++)
-				if (data[start+j] != data[i+j])
-					break;
-			if (j > bestlength)
-			{
-				bestlength = j;
-				beststart = start;
-			}
-		}
+		bestlength = AGMV_FindMatch(finder,data,i,max,pos,BACK_WINDOW,&beststart);
 		
 		beststart = BACK_WINDOW - (i-beststart);
 
@@ -148,96 +225,196 @@ u32 AGMV_LZSS (FILE* file, AGMV_BITSTREAM* in)
 		{	/* output a single char */
 			bestlength = 1;
 
-			AGMV_WriteBits(file,1,1);
-			AGMV_WriteBits(file,val,8);
+			AGMV_PutBits(out,1,1);
+			AGMV_PutBits(out,val,8);
 			
 			outbits += 9;
 		}
 		else
 		{
-			AGMV_WriteBits(file,0,1);
+			AGMV_PutBits(out,0,1);
 			if(BACK_WINDOW-beststart < 65536){
-				AGMV_WriteBits(file,BACK_WINDOW-beststart,16);
+				AGMV_PutBits(out,BACK_WINDOW-beststart,16);
 			}
 			else{
-				AGMV_WriteBits(file,65535,16);
+				AGMV_PutBits(out,65535,16);
 			}
-			AGMV_WriteBits(file,bestlength,4);
+			AGMV_PutBits(out,bestlength,4);
 			
 			outbits += 21;
 		}
 
-		while (bestlength--)
-		{
-			i++;
-		}
+		i += bestlength;
 	}
 	
+	free(finder);
+	
 	return outbits / 8.0f;
 }
 
-u32 AGMV_LZ77(FILE* file, AGMV_BITSTREAM* in)
+/* LZ77 TOKENS ARE ALWAYS FOUR BYTES, SO A MATCH OF ANY LENGTH IS WORTH TAKING. FALLS BACK TO THE NEWEST TWO OR ONE BYTE
+   MATCH WHEN NO THREE BYTE MATCH EXISTS */
+static int AGMV_FindLZ77Match(AGMV_MATCH_FINDER* finder, const u8* data, int i, int max, int pos, int* beststart){
+	int bestlength = AGMV_FindMatch(finder,data,i,max,pos,BACK_WINDOW,beststart), start, j;
+	
+	if(bestlength > 0 || max < 1){
+		return bestlength;
+	}
+	
+	start = max >= 2 ? finder->last2[data[i] << 8 | data[i+1]] : -1;
+	
+	if(start < 0 || start < i - BACK_WINDOW){
+		start = finder->last1[data[i]];
+	}
+	
+	if(start < 0 || start < i - BACK_WINDOW){
+		return 0;
+	}
+	
+	for(j = 0; j < max; j++){
+		if(data[start+j] != data[i+j]){
+			break;
+		}
+	}
+	
+	*beststart = start;
+	
+	return j;
+}
+
+static void AGMV_PutLZ77Token(AGMV_BITSTREAM* out, int offset, int length, u8 literal){
+	AGMV_PutShort(out,offset);
+	AGMV_PutByte(out,length);
+	AGMV_PutByte(out,literal);
+}
+
+/* EVERY TOKEN IS A MATCH FOLLOWED BY ONE LITERAL, SO A MATCH MAY RUN AT MOST TO THE BYTE BEFORE THE END */
+static int AGMV_LZ77Max(int i, int pos){
+	return pos - i - 1 < 255 ? pos - i - 1 : 255;
+}
+
+/* GREEDY TAKES THE LONGEST MATCH AT EACH POSITION. OPTIMAL FINDS THE LONGEST MATCH AT EVERY POSITION AND PICKS THE SMALLEST
+   NUMBER OF TOKENS, USING THAT ANY PREFIX OF A MATCH IS ALSO A MATCH, SO IT IS NEVER LARGER THAN GREEDY */
+u32 AGMV_CompressLZ77(AGMV_BITSTREAM* out, AGMV_BITSTREAM* in, u32 depth, AGMV_LZ_PARSE parse)
 {
-	int		i;
-	int		val;
-	int		j, start, max;
+	int		i, k;
 	int		bestlength, beststart;
 	int		outbits = 0;
 	int     pos = in->pos;
 	u8*     data = in->data;
+	AGMV_MATCH_FINDER* finder = AGMV_CreateMatchFinder(depth);
 
-	outbits = 0;
-	for (i=0 ; i<pos ; )
-	{
-		val = data[i];
+	AGMV_ReserveBitstream(out,pos*4);
 
-		max = 255;
-		if (i + max > pos)
-			max = in->pos - i;
-
-		start = i - BACK_WINDOW;
-		if (start < 0)
-			start = 0;
-		bestlength = 0;
-		beststart = 0;
-		for ( ; start < i ; start++)
+	if(parse == AGMV_PARSE_OPTIMAL && pos > 0)
+	{
+		int* length = (int*)malloc(sizeof(int)*pos);
+		int* start = (int*)malloc(sizeof(int)*pos);
+		int* cost = (int*)malloc(sizeof(int)*(pos+1));
+		u8* choice = (u8*)malloc(pos);
+		
+		for (i=0 ; i<pos ; i++)
+		{
+			start[i] = 0;
+			length[i] = AGMV_FindLZ77Match(finder,data,i,AGMV_LZ77Max(i,pos),pos,&start[i]);
+		}
+		
+		cost[pos] = 0;
+		for (i=pos-1 ; i>=0 ; i--)
 		{
-			if (data[start] != val)
-				continue;
-			// count match length
-			for (j=0 ; j<max ; j++)
-				if (data[start+j] != data[i+j])
-					break;
-			if (j > bestlength)
+			cost[i] = cost[i+1] + 1;
+			choice[i] = 0;
+			
+			for (k=length[i] ; k>0 ; k--)
 			{
-				bestlength = j;
-				beststart = i - start;
+				if (cost[i+k+1] + 1 < cost[i])
+				{
+					cost[i] = cost[i+k+1] + 1;
+					choice[i] = k;
+				}
 			}
 		}
+		
+		for (i=0 ; i<pos ; )
+		{
+			k = choice[i];
+			AGMV_PutLZ77Token(out,k ? i - start[i] : 0,k,data[i+k]);
+			i += k + 1;
+			outbits += 32;
+		}
+		
+		free(length);
+		free(start);
+		free(cost);
+		free(choice);
+		free(finder);
+		
+		return outbits / 8.0f;
+	}
 
+	for (i=0 ; i<pos ; )
+	{
+		beststart = 0;
+		bestlength = AGMV_FindLZ77Match(finder,data,i,AGMV_LZ77Max(i,pos),pos,&beststart);
+		
 		if (bestlength > 0)
 		{	
-			AGMV_WriteShort(file,beststart);
-			AGMV_WriteByte(file,bestlength);
-			AGMV_WriteByte(file,in->data[i+bestlength]);
-			i += bestlength + 1;
+			AGMV_PutLZ77Token(out,i - beststart,bestlength,data[i+bestlength]);
 		}
 		else
 		{
-			
-			AGMV_WriteShort(file,0);
-			AGMV_WriteByte(file,0);
-			AGMV_WriteByte(file,in->data[i]);
-			i++;
+			AGMV_PutLZ77Token(out,0,0,data[i]);
 		}
 		
+		i += bestlength + 1;
 		outbits += 32;
 	}
 	
+	free(finder);
+	
 	return outbits / 8.0f;
 }
 
-u8 AGMV_ComparePFrameBlock(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry){
+/* FILE WRAPPERS FOR CALLERS THAT STREAM STRAIGHT TO DISK, USING THE DEFAULT SEARCH DEPTH. THE PAYLOAD IS STILL BUILT IN MEMORY
+   AND WRITTEN ONCE, AND ANY PARTIAL BYTE IS LEFT IN IN->BITBUF FOR AGMV_FLUSHWRITEBITS, AS BEFORE */
+static u32 AGMV_CompressToFile(FILE* file, AGMV_BITSTREAM* in, AGMV_COMPRESSION compression){
+	AGMV_BITSTREAM out;
+	u32 csize;
+	
+	out.data = NULL;
+	out.len = 0;
+	out.pos = 0;
+	out.bitbuf = 0;
+	out.bitsin = 0;
+	
+	if(compression == AGMV_LZSS_COMPRESSION){
+		csize = AGMV_CompressLZSS(&out,in,AGMV_DEFAULT_MATCH_DEPTH);
+	}
+	else{
+		csize = AGMV_CompressLZ77(&out,in,AGMV_DEFAULT_MATCH_DEPTH,AGMV_DEFAULT_LZ77_PARSE);
+	}
+	
+	fwrite(out.data,1,out.pos,file);
+	
+	in->bitbuf = out.bitbuf;
+	in->bitsin = out.bitsin;
+	
+	free(out.data);
+	
+	return csize;
+}
+
+u32 AGMV_LZSS(FILE* file, AGMV_BITSTREAM* in){
+	return AGMV_CompressToFile(file,in,AGMV_LZSS_COMPRESSION);
+}
+
+u32 AGMV_LZ77(FILE* file, AGMV_BITSTREAM* in){
+	return AGMV_CompressToFile(file,in,AGMV_LZ77_COMPRESSION);
+}
+
+/* THE ENCODE FUNCTIONS BELOW TAKE THEIR OUTPUT BITSTREAM AND THE GOP'S I-FRAME ENTRIES EXPLICITLY, SO FRAMES OF THE SAME VIDEO CAN
+   BE ASSEMBLED ON DIFFERENT THREADS. EVERYTHING ELSE THEY READ FROM AGMV IS CONSTANT WHILE ENCODING */
+static u8 AGMV_CompareBlockToIFrame(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry, AGMV_ENTRY* iframe_entries){
 	u32 i, j, width, color1, color2;
 	int r1, g1, b1, r2, g2, b2, rdiff, gdiff, bdiff;
 	u8 count;
@@ -245,8 +422,6 @@ u8 AGMV_ComparePFrameBlock(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry){
 	width = agmv->frame->width;
 	count = 0;
 	
-	AGMV_ENTRY* iframe_entries = agmv->iframe_entries;
-	
 	for(j = 0; j < 4; j++){
 		for(i = 0; i < 4; i++){
 			AGMV_ENTRY ent1 = entry[(x+i)+(y+j)*width];
@@ -299,6 +474,10 @@ u8 AGMV_ComparePFrameBlock(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry){
 	return count;
 }
 
+u8 AGMV_ComparePFrameBlock(AGMV* agmv, u32 x, u32 y, AGMV_ENTRY* entry){
+	return AGMV_CompareBlockToIFrame(agmv,x,y,entry,agmv->iframe_entries);
+}
+
 u8 AGMV_CompareIFrameBlock(AGMV* agmv, u32 x, u32 y, u32 color, AGMV_ENTRY* img_entry){
 	u32 i, j, width;
 	int r1, g1, b1, r2, g2, b2, rdiff, gdiff, bdiff;
@@ -351,10 +530,10 @@ u8 AGMV_CompareIFrameBlock(AGMV* agmv, u32 x, u32 y, u32 color, AGMV_ENTRY* img_
 	return count;
 }
 
-void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
+static void AGMV_AssembleIFrame(AGMV* agmv, AGMV_BITSTREAM* bitstream, AGMV_ENTRY* img_entry){
 	AGMV_OPT opt;
 	u32 width, height, x, y, i, j;
-	u8* data = agmv->bitstream->data;			
+	u8* data = bitstream->data;			
 	
 	width = agmv->frame->width;
 	height = agmv->frame->height;
@@ -378,26 +557,26 @@ void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 				count = AGMV_CompareIFrameBlock(agmv,x,y,color,img_entry);
 				
 				if(count >= AGMV_FILL_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_FILL_FLAG;
+					data[bitstream->pos++] = AGMV_FILL_FLAG;
 					if(entry.index < 127){
-						data[agmv->bitstream->pos++] = entry.pal_num << 7 | entry.index;
+						data[bitstream->pos++] = entry.pal_num << 7 | entry.index;
 					}
 					else{
-						data[agmv->bitstream->pos++] = entry.pal_num << 7 | 127;
-						data[agmv->bitstream->pos++] = entry.index;
+						data[bitstream->pos++] = entry.pal_num << 7 | 127;
+						data[bitstream->pos++] = entry.index;
 					}
 				}
 				else{
-					data[agmv->bitstream->pos++] = AGMV_NORMAL_FLAG;
+					data[bitstream->pos++] = AGMV_NORMAL_FLAG;
 					for(j = 0; j < 4; j++){
 						for(i = 0; i < 4; i++){
 							AGMV_ENTRY norm = img_entry[(x+i)+(y+j)*width];
 							if(norm.index < 127){
-								data[agmv->bitstream->pos++] = norm.pal_num << 7 | norm.index;
+								data[bitstream->pos++] = norm.pal_num << 7 | norm.index;
 							}
 							else{
-								data[agmv->bitstream->pos++] = norm.pal_num << 7 | 127;
-								data[agmv->bitstream->pos++] = norm.index;
+								data[bitstream->pos++] = norm.pal_num << 7 | 127;
+								data[bitstream->pos++] = norm.index;
 							}
 						}
 					}
@@ -417,16 +596,16 @@ void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 				count = AGMV_CompareIFrameBlock(agmv,x,y,color,img_entry);
 				
 				if(count >= AGMV_FILL_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_FILL_FLAG;
-					data[agmv->bitstream->pos++] = entry.index;
+					data[bitstream->pos++] = AGMV_FILL_FLAG;
+					data[bitstream->pos++] = entry.index;
 				}
 				else{
-					data[agmv->bitstream->pos++] = AGMV_NORMAL_FLAG;
+					data[bitstream->pos++] = AGMV_NORMAL_FLAG;
 	
 					for(j = 0; j < 4; j++){
 						for(i = 0; i < 4; i++){
 							AGMV_ENTRY entry = img_entry[(x+i)+(y+j)*width];
-							data[agmv->bitstream->pos++] = entry.index;
+							data[bitstream->pos++] = entry.index;
 						}
 					}
 				}
@@ -435,10 +614,10 @@ void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 	}
 }
 
-void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
+static void AGMV_AssemblePFrame(AGMV* agmv, AGMV_BITSTREAM* bitstream, AGMV_ENTRY* img_entry, AGMV_ENTRY* iframe_entries){
 	AGMV_OPT opt;
 	u32 width, height, x, y, i, j;
-	u8* data = agmv->bitstream->data;			
+	u8* data = bitstream->data;			
 	
 	width = agmv->frame->width;
 	height = agmv->frame->height;
@@ -460,32 +639,32 @@ void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 				}
 				
 				count1 = AGMV_CompareIFrameBlock(agmv,x,y,color,img_entry);
-				count2 = AGMV_ComparePFrameBlock(agmv,x,y,img_entry);
+				count2 = AGMV_CompareBlockToIFrame(agmv,x,y,img_entry,iframe_entries);
 				
 				if(count2 >= AGMV_COPY_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_COPY_FLAG;
+					data[bitstream->pos++] = AGMV_COPY_FLAG;
 				}
 				else if(count1 >= AGMV_FILL_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_FILL_FLAG;
+					data[bitstream->pos++] = AGMV_FILL_FLAG;
 					if(entry.index < 127){
-						data[agmv->bitstream->pos++] = entry.pal_num << 7 | entry.index;
+						data[bitstream->pos++] = entry.pal_num << 7 | entry.index;
 					}
 					else{
-						data[agmv->bitstream->pos++] = entry.pal_num << 7 | 127;
-						data[agmv->bitstream->pos++] = entry.index;
+						data[bitstream->pos++] = entry.pal_num << 7 | 127;
+						data[bitstream->pos++] = entry.index;
 					}
 				}
 				else{
-					data[agmv->bitstream->pos++] = AGMV_NORMAL_FLAG;
+					data[bitstream->pos++] = AGMV_NORMAL_FLAG;
 					for(j = 0; j < 4; j++){
 						for(i = 0; i < 4; i++){
 							AGMV_ENTRY norm = img_entry[(x+i)+(y+j)*width];
 							if(norm.index < 127){
-								data[agmv->bitstream->pos++] = norm.pal_num << 7 | norm.index;
+								data[bitstream->pos++] = norm.pal_num << 7 | norm.index;
 							}
 							else{
-								data[agmv->bitstream->pos++] = norm.pal_num << 7 | 127;
-								data[agmv->bitstream->pos++] = norm.index;
+								data[bitstream->pos++] = norm.pal_num << 7 | 127;
+								data[bitstream->pos++] = norm.index;
 							}
 						}
 					}
@@ -502,22 +681,22 @@ void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 	
 				color  = agmv->header.palette0[entry.index];
 				count1 = AGMV_CompareIFrameBlock(agmv,x,y,color,img_entry);
-				count2 = AGMV_ComparePFrameBlock(agmv,x,y,img_entry);
+				count2 = AGMV_CompareBlockToIFrame(agmv,x,y,img_entry,iframe_entries);
 				
 				if(count2 >= AGMV_COPY_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_COPY_FLAG;
+					data[bitstream->pos++] = AGMV_COPY_FLAG;
 				}
 				else if(count1 >= AGMV_FILL_COUNT){
-					data[agmv->bitstream->pos++] = AGMV_FILL_FLAG;
-					data[agmv->bitstream->pos++] = entry.index;
+					data[bitstream->pos++] = AGMV_FILL_FLAG;
+					data[bitstream->pos++] = entry.index;
 				}
 				else{
-					data[agmv->bitstream->pos++] = AGMV_NORMAL_FLAG;
+					data[bitstream->pos++] = AGMV_NORMAL_FLAG;
 	
 					for(j = 0; j < 4; j++){
 						for(i = 0; i < 4; i++){
 							AGMV_ENTRY entry = img_entry[(x+i)+(y+j)*width];
-							data[agmv->bitstream->pos++] = entry.index;
+							data[bitstream->pos++] = entry.index;
 						}
 					}
 				}
@@ -526,103 +705,199 @@ void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
 	}
 }
 
-void AGMV_EncodeFrame(FILE* file, AGMV* agmv, u32* img_data){
+void AGMV_AssembleIFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
+	AGMV_AssembleIFrame(agmv,agmv->bitstream,img_entry);
+}
+
+void AGMV_AssemblePFrameBitstream(AGMV* agmv, AGMV_ENTRY* img_entry){
+	AGMV_AssemblePFrame(agmv,agmv->bitstream,img_entry,agmv->iframe_entries);
+}
+
+static void AGMV_QuantizeFrame(AGMV* agmv, const u32* img_data, AGMV_ENTRY* img_entry){
 	AGMV_OPT opt = AGMV_GetOPT(agmv);
-	AGMV_COMPRESSION compression = AGMV_GetCompression(agmv);
-	AGMV_ENTRY* iframe_entries, *img_entry;
+	int i, size = AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv);
+	
+	if(opt != AGMV_OPT_II && opt != AGMV_OPT_ANIM && opt != AGMV_OPT_GBA_II){
+		for(i = 0; i < size; i++){
+			img_entry[i] = AGMV_FindNearestEntry(agmv->header.palette0,agmv->header.palette1,img_data[i]);
+		}
+	}
+	else{
+		for(i = 0; i < size; i++){
+			img_entry[i].index = AGMV_FindNearestColor(agmv->header.palette0,img_data[i]);
+			img_entry[i].pal_num = 0;
+		}
+	}
+}
 
-	int i, csize, pos, size, max_size;
-	u32 palette0[256], palette1[256];
+/* THE WHOLE CHUNK IS BUILT IN MEMORY, SO COMPRESSED_SIZE IS KNOWN BEFORE ANYTHING REACHES THE FILE AND NO SEEKS ARE NEEDED */
+/* DECOMPRESSES A FINISHED PAYLOAD THE WAY AGMV_DecompressFrame DOES AND CHECKS THAT THE DECODER WOULD DRAW EVERY BLOCK. DROPPING THE
+   TRAILING PARTIAL BYTE CAN CUT THE LAST TOKEN SHORT, AND THE DECODER THEN ESCAPES BEFORE THE LAST BLOCKS */
+static Bool AGMV_IsPayloadClean(AGMV* agmv, const u8* payload, u32 csize, u32 usize){
+	u32 len = AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv)*2, bpos;
+	u8* data = (u8*)malloc(len+16);
+	Bool clean;
 	
-	for(i = 0; i < 256; i++){
-		palette0[i] = agmv->header.palette0[i];
-		palette1[i] = agmv->header.palette1[i];
+	if(agmv->header.version == 1 || agmv->header.version == 2){
+		bpos = AGMV_DecompressLZSS(payload,csize,data,usize,len);
+	}
+	else{
+		bpos = AGMV_DecompressLZ77(payload,csize,data,len);
 	}
 	
-	size     = AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv);
-	max_size = size + (size * 0.08f);
+	clean = AGMV_IsFrameComplete(agmv,data,bpos);
 	
-	iframe_entries = agmv->iframe_entries;
-	img_entry = (AGMV_ENTRY*)malloc(sizeof(AGMV_ENTRY)*size);
+	free(data);
+	
+	return clean;
+}
 
-	AGMV_SyncFrameAndImage(agmv,img_data);
-	AGMV_WriteFourCC(file,'A','G','F','C');
-	AGMV_WriteLong(file,agmv->frame_count+1);
+/* RETURNS THE CHUNK'S SEEK INDEX FLAGS. AN I-FRAME IS MARKED CLEAN WHEN DECODING IT ALONE DRAWS THE WHOLE FRAME */
+static u8 AGMV_BuildFrameChunk(AGMV* agmv, AGMV_BITSTREAM* chunk, AGMV_BITSTREAM* bitstream, u32 frame_num){
+	u32 csize, i;
+	
+	chunk->pos = 0;
+	chunk->bitbuf = 0;
+	chunk->bitsin = 0;
+	
+	AGMV_PutFourCC(chunk,'A','G','F','C');
+	AGMV_PutLong(chunk,frame_num+1);
+	AGMV_PutLong(chunk,bitstream->pos);
+	AGMV_PutLong(chunk,0);
+	
+	if(AGMV_GetCompression(agmv) == AGMV_LZSS_COMPRESSION){
+		csize = AGMV_CompressLZSS(chunk,bitstream,AGMV_GetMatchDepth(agmv));
+	}
+	else{
+		csize = AGMV_CompressLZ77(chunk,bitstream,AGMV_GetMatchDepth(agmv),AGMV_GetLZ77Parse(agmv));
+	}
+	
+	/* COMPRESSED_SIZE COUNTS WHOLE BYTES ONLY. A TRAILING PARTIAL BYTE IS DROPPED AND THE 0xFF PADDING TAKES ITS PLACE */
+	chunk->pos = 16 + csize;
+	chunk->bitbuf = 0;
+	chunk->bitsin = 0;
+	
+	memcpy(chunk->data + 12,&csize,4);
+	
+	for(i = 0; i < 8; i++){
+		AGMV_PutByte(chunk,0xff);
+	}
+	
+	if(frame_num % 4 != 0){
+		return 0;
+	}
+	
+	return AGMV_INDEX_IFRAME | AGMV_INDEX_CHECKED | (AGMV_IsPayloadClean(agmv,chunk->data+16,csize,bitstream->pos) ? AGMV_INDEX_CLEAN : 0);
+}
 
-	agmv->bitstream->pos = 0;
+static void AGMV_QuantizeTask(void* data, u32 index){
+	AGMV* agmv = (AGMV*)data;
+	AGMV_ENCODE_SLOT* slot = &agmv->encoder->slots[index];
+	
+	AGMV_QuantizeFrame(agmv,slot->img_data,slot->img_entry);
+}
 
-	if(opt != AGMV_OPT_II && opt != AGMV_OPT_ANIM && opt != AGMV_OPT_GBA_II){
+static void AGMV_CompressTask(void* data, u32 index){
+	AGMV* agmv = (AGMV*)data;
+	AGMV_ENCODER* encoder = agmv->encoder;
+	AGMV_ENCODE_SLOT* slot = &encoder->slots[index];
+	u32 k = slot->frame_num % 4;
+	
+	slot->bitstream.pos = 0;
+	
+	if(k == 0){
+		AGMV_AssembleIFrame(agmv,&slot->bitstream,slot->img_entry);
+	}
+	else{
+		/* QUEUED FRAMES ARE CONSECUTIVE, SO THE GOP'S I-FRAME IS K SLOTS BACK, OR IN AGMV->IFRAME_ENTRIES IF AN EARLIER BATCH HELD IT */
+		AGMV_AssemblePFrame(agmv,&slot->bitstream,slot->img_entry,index >= k ? encoder->slots[index-k].img_entry : agmv->iframe_entries);
+	}
+	
+	slot->flags = AGMV_BuildFrameChunk(agmv,&slot->chunk,&slot->bitstream,slot->frame_num);
+}
+
+/* ENCODES EVERY QUEUED FRAME ON THE THREAD POOL, ALL QUANTIZATION FIRST SINCE P-FRAMES COMPARE AGAINST THEIR I-FRAME'S ENTRIES, THEN
+   WRITES THE FINISHED CHUNKS AND ANY AUDIO QUEUED BEHIND THEM IN FRAME ORDER */
+void AGMV_FlushEncoder(FILE* file, AGMV* agmv){
+	AGMV_ENCODER* encoder = agmv->encoder;
+	AGMV_ENCODE_SLOT* slot;
+	u32 i, count;
+	
+	if(encoder == NULL || encoder->count == 0){
+		return;
+	}
+	
+	count = encoder->count;
+	
+	AGMV_ThreadPoolRun(agmv->pool,AGMV_QuantizeTask,agmv,count);
+	AGMV_ThreadPoolRun(agmv->pool,AGMV_CompressTask,agmv,count);
+	
+	for(i = 0; i < count; i++){
+		slot = &encoder->slots[i];
 		
-		for(i = 0; i < size; i++){
-			img_entry[i] = AGMV_FindNearestEntry(palette0,palette1,img_data[i]);
-		}
+		AGMV_SetIndexFrameOffset(agmv,slot->frame_num,ftell(file),slot->flags);
+		fwrite(slot->chunk.data,1,slot->chunk.pos,file);
 		
-		if(agmv->frame_count % 4 == 0){
-			AGMV_AssembleIFrameBitstream(agmv,img_entry);
-		}
-		else{
-			AGMV_AssemblePFrameBitstream(agmv,img_entry);
+		if(slot->audio.pos > 0){
+			AGMV_SetIndexAudioOffset(agmv,slot->frame_num,ftell(file)+slot->audio_offset);
+			fwrite(slot->audio.data,1,slot->audio.pos,file);
 		}
-
-		AGMV_WriteLong(file,agmv->bitstream->pos);
-		AGMV_WriteLong(file,0);
-
-		pos = ftell(file);
+	}
+	
+	for(i = count; i > 0; i--){
+		slot = &encoder->slots[i-1];
 		
-		if(AGMV_GetCompression(agmv) == AGMV_LZSS_COMPRESSION){
-			csize = AGMV_LZSS(file,agmv->bitstream);
-		}
-		else{
-			csize = AGMV_LZ77(file,agmv->bitstream);
+		if(slot->frame_num % 4 == 0){
+			memcpy(agmv->iframe_entries,slot->img_entry,sizeof(AGMV_ENTRY)*AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv));
+			break;
 		}
-		
-		AGMV_FlushWriteBits(file);
-		
-		fseek(file,pos-4,SEEK_SET);
-		
-		AGMV_WriteLong(file,csize);
+	}
+	
+	encoder->count = 0;
+}
 
-		fseek(file,csize,SEEK_CUR);
+void AGMV_EncodeFrame(FILE* file, AGMV* agmv, u32* img_data){
+	AGMV_ENTRY* iframe_entries, *img_entry;
+	AGMV_ENCODER* encoder = agmv->encoder;
+	int i, size = AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv);
+	u8 flags;
+	
+	AGMV_SyncFrameAndImage(agmv,img_data);
+	
+	if(encoder != NULL){
+		AGMV_ENCODE_SLOT* slot = &encoder->slots[encoder->count++];
 		
-	}
-	else{
-		for(i = 0; i < size; i++){
-			img_entry[i].index = AGMV_FindNearestColor(palette0,img_data[i]);
-			img_entry[i].pal_num = 0;
-		}
+		slot->frame_num = agmv->frame_count++;
+		slot->audio.pos = 0;
+		slot->audio_offset = 0;
+		AGMV_CopyImageData(slot->img_data,img_data,size);
 		
-		if(agmv->frame_count % 4 == 0){
-			AGMV_AssembleIFrameBitstream(agmv,img_entry);
+		if(encoder->count == encoder->capacity){
+			AGMV_FlushEncoder(file,agmv);
 		}
-		else{
-			AGMV_AssemblePFrameBitstream(agmv,img_entry);
-		}
-
-		AGMV_WriteLong(file,agmv->bitstream->pos);
-		AGMV_WriteLong(file,0);
 		
-		pos = ftell(file);
+		return;
+	}
+	
+	iframe_entries = agmv->iframe_entries;
+	img_entry = (AGMV_ENTRY*)malloc(sizeof(AGMV_ENTRY)*size);
 
-		if(AGMV_GetCompression(agmv) == AGMV_LZSS_COMPRESSION){
-			csize = AGMV_LZSS(file,agmv->bitstream);
-		}
-		else{
-			csize = AGMV_LZ77(file,agmv->bitstream);
-		}
-		
-		AGMV_FlushWriteBits(file);
-		
-		fseek(file,pos-4,SEEK_SET);
-		
-		AGMV_WriteLong(file,csize);
+	agmv->bitstream->pos = 0;
 
-		fseek(file,csize,SEEK_CUR);
-	}
+	AGMV_QuantizeFrame(agmv,img_data,img_entry);
 	
-	for(i = 0; i < 8; i++){
-		AGMV_WriteByte(file,0xff);
+	if(agmv->frame_count % 4 == 0){
+		AGMV_AssembleIFrameBitstream(agmv,img_entry);
+	}
+	else{
+		AGMV_AssemblePFrameBitstream(agmv,img_entry);
 	}
 	
+	flags = AGMV_BuildFrameChunk(agmv,agmv->payload,agmv->bitstream,agmv->frame_count);
+	
+	AGMV_SetIndexFrameOffset(agmv,agmv->frame_count,ftell(file),flags);
+	fwrite(agmv->payload->data,1,agmv->payload->pos,file);
+	
 	if(agmv->frame_count % 4 == 0){
 		for(i = 0; i < size; i++){
 			iframe_entries[i] = img_entry[i];
@@ -707,6 +982,27 @@ void AGMV_CompressAudio(AGMV* agmv){
 void AGMV_EncodeAudioChunk(FILE* file, AGMV* agmv){
 	int i, size = agmv->audio_chunk->size;
 	u8* atsample = agmv->audio_chunk->atsample;
+	
+	/* WHILE FRAMES ARE QUEUED, THE AUDIO CHUNK WAITS BEHIND THE NEWEST ONE SO IT IS WRITTEN IN THE SAME PLACE */
+	if(agmv->encoder != NULL && agmv->encoder->count > 0){
+		AGMV_ENCODE_SLOT* slot = &agmv->encoder->slots[agmv->encoder->count-1];
+		
+		slot->audio_offset = slot->audio.pos;
+		
+		AGMV_ReserveBitstream(&slot->audio,size+8);
+		AGMV_PutFourCC(&slot->audio,'A','G','A','C');
+		AGMV_PutLong(&slot->audio,agmv->audio_chunk->size);
+		
+		for(i = 0; i < size; i++){
+			AGMV_PutByte(&slot->audio,atsample[agmv->audio_track->start_point++]);
+		}
+		
+		return;
+	}
+	
+	if(agmv->frame_count != 0){
+		AGMV_SetIndexAudioOffset(agmv,agmv->frame_count-1,ftell(file));
+	}
 		
 	AGMV_WriteFourCC(file,'A','G','A','C');
 	AGMV_WriteLong(file,agmv->audio_chunk->size);
@@ -716,9 +1012,44 @@ void AGMV_EncodeAudioChunk(FILE* file, AGMV* agmv){
 	}
 }
 
+void AGMV_EncodeIndexChunk(FILE* file, AGMV* agmv){
+	u32 i, pos, len;
+	AGMV_INDEX_ENTRY* entries;
+	
+	AGMV_FlushEncoder(file,agmv);
+	
+	len = agmv->index != NULL ? agmv->index->len : 0;
+	
+	if(len == 0){
+		return;
+	}
+	
+	entries = agmv->index->entries;
+	
+	/* AN UNSEEKABLE OUTPUT SUCH AS A PIPE CANNOT HAVE ITS HEADER PATCHED, SO IT IS LEFT WITHOUT AN INDEX */
+	if(fseek(file,0,SEEK_END) != 0){
+		return;
+	}
+	
+	pos = ftell(file);
+	
+	AGMV_WriteFourCC(file,'A','G','I','C');
+	AGMV_WriteLong(file,len);
+	
+	for(i = 0; i < len; i++){
+		AGMV_WriteLong(file,entries[i].frame_offset);
+		AGMV_WriteLong(file,entries[i].audio_offset);
+		AGMV_WriteByte(file,entries[i].flags);
+	}
+	
+	fseek(file,AGMV_GetHeaderSize(agmv)+4,SEEK_SET);
+	AGMV_WriteLong(file,pos);
+	
+	fseek(file,0,SEEK_END);
+}
+
 void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression){
-	u32 i, palette0[256], palette1[256], n, count = 0, num_of_frames_encoded = 0, w, h, num_of_pix, max_clr, size = width*height;
-	u32 pal[512];
+	u32 i, palette0[256], palette1[256], num_of_frames_encoded = 0, w, h, num_of_pix, max_clr, size = width*height;
 	
 	AGMV* agmv = CreateAGMV(end_frame-start_frame,width,height,frames_per_second);
 	AGMV_SetOPT(agmv,opt);
@@ -739,8 +1070,7 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 		}break;
 	}
 	
-	u32* colorgram = (u32*)malloc(sizeof(u32)*max_clr+5);
-	u32* histogram = (u32*)malloc(sizeof(u32)*max_clr+5);
+	u32* histogram = (u32*)malloc(sizeof(u32)*(max_clr+1));
 	
 	switch(opt){
 		case AGMV_OPT_I:{
@@ -796,18 +1126,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 		}break;
 	}
 	
-	for(i = 0; i < 512; i++){
-		if(i < 256){
-			palette0[i] = 0;
-			palette1[i] = 0;
-		}
-		
-		pal[i] = 0;
-	}
-	
 	for(i = 0; i < max_clr; i++){
 		histogram[i] = 1;
-		colorgram[i] = i;
 	}
 	
 	char* ext = AGIDL_GetImgExtension(img_type);
@@ -1011,95 +1331,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 		}
 	}
 
-	AGMV_BubbleSort(histogram,colorgram,max_clr);
+	AGMV_BuildPalettes(histogram,max_clr,quality,opt,palette0,palette1);
 	
-	for(n = max_clr; n > 0; n--){
-		Bool skip = FALSE;
-			
-		u32 clr = colorgram[n];
-		
-		int r = AGMV_GetQuantizedR(clr,quality);
-		int g = AGMV_GetQuantizedG(clr,quality);
-		int b = AGMV_GetQuantizedB(clr,quality);
-		
-		int j;
-		for(j = 0; j < 512; j++){
-			u32 palclr = pal[j];
-			
-			int palr = AGMV_GetQuantizedR(palclr,quality);
-			int palg = AGMV_GetQuantizedG(palclr,quality);
-			int palb = AGMV_GetQuantizedB(palclr,quality);
-			
-			int rdiff = r-palr;
-			int gdiff = g-palg;
-			int bdiff = b-palb;
-			
-			if(rdiff < 0){
-				rdiff = AGIDL_Abs(rdiff);
-			}
-			
-			if(gdiff < 0){
-				gdiff = AGIDL_Abs(gdiff);
-			}
-			
-			if(bdiff < 0){
-				bdiff = AGIDL_Abs(bdiff);
-			}
-			
-			if(quality == AGMV_HIGH_QUALITY){
-				if(rdiff <= 2 && gdiff <= 2 && bdiff <= 3){
-					skip = TRUE;
-				}
-			}
-			else{
-				if(rdiff <= 1 && gdiff <= 1 && bdiff <= 1){
-					skip = TRUE;
-				}
-			}
-		}
-		
-		if(skip == FALSE){
-			pal[count] = clr;
-			count++;
-		}
-		
-		if(count >= 512){
-			break;
-		}
-	}
-	
-	if(opt == AGMV_OPT_I || opt == AGMV_OPT_GBA_I || opt == AGMV_OPT_III || opt == AGMV_OPT_GBA_III || opt == AGMV_OPT_NDS){
-		for(n = 0; n < 512; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			if(n < 126){
-				palette0[n] = invclr;
-			}
-			else if(n >= 126 && n <= 252){
-				palette1[n-126] = invclr;
-			}
-			
-			if(n > 252 && n <= 381){
-				palette0[n-126] = invclr;
-			}
-			
-			if(n > 381 && (n-255) < 256){
-				palette1[n-255] = invclr;
-			}
-		}
-	}
-	
-	if(opt == AGMV_OPT_II || opt == AGMV_OPT_GBA_II|| opt == AGMV_OPT_ANIM){
-		for(n = 0; n < 256; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			palette0[n] = invclr;
-		}
-	}
-	
-	free(colorgram);
 	free(histogram);
 	
 	FILE* file = fopen(filename,"wb");
@@ -1107,6 +1340,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 	AGMV_SetICP0(agmv,palette0);
 	AGMV_SetICP1(agmv,palette1);
 	
+	AGMV_SetEncodeThreads(agmv,0);
+	
 	printf("Encoding AGMV Header...\n");
 	AGMV_EncodeHeader(file,agmv);
 	printf("Encoded AGMV Header...\n");
@@ -2223,6 +2458,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 		}
 	}
 	
+	AGMV_FlushEncoder(file,agmv);
+	
 	fseek(file,4,SEEK_SET);
 	AGIDL_WriteLong(file,num_of_frames_encoded);
 
@@ -2230,6 +2467,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 	f32 rate = (f32)num_of_frames_encoded/AGMV_GetNumberOfFrames(agmv);
 	AGIDL_WriteLong(file,round(AGMV_GetFramesPerSecond(agmv)*rate));
 		
+	AGMV_EncodeIndexChunk(file,agmv);
+	
 	fclose(file);
 	
 	free(ext);
@@ -2268,9 +2507,8 @@ void AGMV_EncodeVideo(const char* filename, const char* dir, const char* basenam
 }
 
 void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression){
-	u32 i, palette0[256], palette1[256], n, count = 0, num_of_frames_encoded = 0, w, h, num_of_pix, max_clr, size = width*height;
+	u32 i, palette0[256], palette1[256], num_of_frames_encoded = 0, w, h, num_of_pix, max_clr, size = width*height;
 	u32 sample_size, adjusted_num_of_frames = end_frame-start_frame;
-	u32 pal[512];
 
 	AGMV_SetOPT(agmv,opt);
 	AGMV_SetCompression(agmv,compression);
@@ -2290,8 +2528,7 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 		}break;
 	}
 	
-	u32* colorgram = (u32*)malloc(sizeof(u32)*max_clr+5);
-	u32* histogram = (u32*)malloc(sizeof(u32)*max_clr+5);
+	u32* histogram = (u32*)malloc(sizeof(u32)*(max_clr+1));
 	
 	switch(opt){
 		case AGMV_OPT_I:{
@@ -2352,18 +2589,8 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 		}break;
 	}
 
-	for(i = 0; i < 512; i++){
-		if(i < 256){
-			palette0[i] = 0;
-			palette1[i] = 0;
-		}
-		
-		pal[i] = 0;
-	}
-	
 	for(i = 0; i < max_clr; i++){
 		histogram[i] = 1;
-		colorgram[i] = i;
 	}
 	
 	char* ext = AGIDL_GetImgExtension(img_type);
@@ -2567,95 +2794,8 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 		}
 	}
 	
-	AGMV_BubbleSort(histogram,colorgram,max_clr);
+	AGMV_BuildPalettes(histogram,max_clr,quality,opt,palette0,palette1);
 	
-	for(n = max_clr; n > 0; n--){
-		Bool skip = FALSE;
-			
-		u32 clr = colorgram[n];
-		
-		int r = AGMV_GetQuantizedR(clr,quality);
-		int g = AGMV_GetQuantizedG(clr,quality);
-		int b = AGMV_GetQuantizedB(clr,quality);
-		
-		int j;
-		for(j = 0; j < 512; j++){
-			u32 palclr = pal[j];
-			
-			int palr = AGMV_GetQuantizedR(palclr,quality);
-			int palg = AGMV_GetQuantizedG(palclr,quality);
-			int palb = AGMV_GetQuantizedB(palclr,quality);
-			
-			int rdiff = r-palr;
-			int gdiff = g-palg;
-			int bdiff = b-palb;
-			
-			if(rdiff < 0){
-				rdiff = AGIDL_Abs(rdiff);
-			}
-			
-			if(gdiff < 0){
-				gdiff = AGIDL_Abs(gdiff);
-			}
-			
-			if(bdiff < 0){
-				bdiff = AGIDL_Abs(bdiff);
-			}
-			
-			if(quality == AGMV_HIGH_QUALITY){
-				if(rdiff <= 2 && gdiff <= 2 && bdiff <= 3){
-					skip = TRUE;
-				}
-			}
-			else{
-				if(rdiff <= 1 && gdiff <= 1 && bdiff <= 1){
-					skip = TRUE;
-				}
-			}
-		}
-		
-		if(skip == FALSE){
-			pal[count] = clr;
-			count++;
-		}
-		
-		if(count >= 512){
-			break;
-		}
-	}
-	
-	if(opt == AGMV_OPT_I || opt == AGMV_OPT_GBA_I || opt == AGMV_OPT_III || opt == AGMV_OPT_GBA_III || opt == AGMV_OPT_NDS){
-		for(n = 0; n < 512; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			if(n < 126){
-				palette0[n] = invclr;
-			}
-			else if(n >= 126 && n <= 252){
-				palette1[n-126] = invclr;
-			}
-			
-			if(n > 252 && n <= 381){
-				palette0[n-126] = invclr;
-			}
-			
-			if(n > 381 && (n-255) < 256){
-				palette1[n-255] = invclr;
-			}
-		}
-	}
-	
-	if(opt == AGMV_OPT_II || opt == AGMV_OPT_GBA_II|| opt == AGMV_OPT_ANIM){
-		for(n = 0; n < 256; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			palette0[n] = invclr;
-		}
-	}
-	
-	free(colorgram);
 	free(histogram);
 	
 	sample_size = agmv->header.audio_size / (f32)adjusted_num_of_frames;
@@ -2671,6 +2811,11 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 	AGMV_SetICP0(agmv,palette0);
 	AGMV_SetICP1(agmv,palette1);
 	
+	/* KEEP ANY THREADING THE CALLER ALREADY SET ON THEIR HANDLE */
+	if(agmv->encoder == NULL && agmv->pool == NULL){
+		AGMV_SetEncodeThreads(agmv,0);
+	}
+	
 	printf("Encoding AGMV Header...\n");
 	AGMV_EncodeHeader(file,agmv);
 	printf("Encoded AGMV Header...\n");
@@ -3612,6 +3757,8 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 		}
 	}
 	
+	AGMV_FlushEncoder(file,agmv);
+	
 	fseek(file,4,SEEK_SET);
 	AGIDL_WriteLong(file,num_of_frames_encoded);
 
@@ -3619,6 +3766,8 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 	f32 rate = (f32)adjusted_num_of_frames/(AGMV_GetNumberOfFrames(agmv)+1);
 	AGIDL_WriteLong(file,round(AGMV_GetFramesPerSecond(agmv)*rate));
 
+	AGMV_EncodeIndexChunk(file,agmv);
+	
 	fclose(file);
 	
 	free(ext);
@@ -3657,9 +3806,8 @@ void AGMV_EncodeAGMV(AGMV* agmv, const char* filename, const char* dir, const ch
 }
 
 void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, const char* basename, u8 img_type, u32 start_frame, u32 end_frame, u32 width, u32 height, u32 frames_per_second, AGMV_OPT opt, AGMV_QUALITY quality, AGMV_COMPRESSION compression){
-	u32 i, palette0[256], palette1[256], n, count = 0, max_clr, size = width*height;
+	u32 i, palette0[256], palette1[256], max_clr, size = width*height;
 	u32 sample_size;
-	u32 pal[512];
 
 	AGMV_SetOPT(agmv,opt);
 	AGMV_SetCompression(agmv,compression);
@@ -3679,8 +3827,7 @@ void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, cons
 		}break;
 	}
 	
-	u32* colorgram = (u32*)malloc(sizeof(u32)*max_clr+5);
-	u32* histogram = (u32*)malloc(sizeof(u32)*max_clr+5);
+	u32* histogram = (u32*)malloc(sizeof(u32)*(max_clr+1));
 	
 	switch(opt){
 		case AGMV_OPT_GBA_I:{
@@ -3714,18 +3861,8 @@ void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, cons
 		}break;
 	}
 
-	for(i = 0; i < 512; i++){
-		if(i < 256){
-			palette0[i] = 0;
-			palette1[i] = 0;
-		}
-		
-		pal[i] = 0;
-	}
-	
 	for(i = 0; i < max_clr; i++){
 		histogram[i] = 1;
-		colorgram[i] = i;
 	}
 	
 	char* ext = AGIDL_GetImgExtension(img_type);
@@ -3929,95 +4066,8 @@ void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, cons
 		}
 	}
 	
-	AGMV_BubbleSort(histogram,colorgram,max_clr);
+	AGMV_BuildPalettes(histogram,max_clr,quality,opt,palette0,palette1);
 	
-	for(n = max_clr; n > 0; n--){
-		Bool skip = FALSE;
-			
-		u32 clr = colorgram[n];
-		
-		int r = AGMV_GetQuantizedR(clr,quality);
-		int g = AGMV_GetQuantizedG(clr,quality);
-		int b = AGMV_GetQuantizedB(clr,quality);
-		
-		int j;
-		for(j = 0; j < 512; j++){
-			u32 palclr = pal[j];
-			
-			int palr = AGMV_GetQuantizedR(palclr,quality);
-			int palg = AGMV_GetQuantizedG(palclr,quality);
-			int palb = AGMV_GetQuantizedB(palclr,quality);
-			
-			int rdiff = r-palr;
-			int gdiff = g-palg;
-			int bdiff = b-palb;
-			
-			if(rdiff < 0){
-				rdiff = AGIDL_Abs(rdiff);
-			}
-			
-			if(gdiff < 0){
-				gdiff = AGIDL_Abs(gdiff);
-			}
-			
-			if(bdiff < 0){
-				bdiff = AGIDL_Abs(bdiff);
-			}
-			
-			if(quality == AGMV_HIGH_QUALITY){
-				if(rdiff <= 2 && gdiff <= 2 && bdiff <= 3){
-					skip = TRUE;
-				}
-			}
-			else{
-				if(rdiff <= 1 && gdiff <= 1 && bdiff <= 1){
-					skip = TRUE;
-				}
-			}
-		}
-		
-		if(skip == FALSE){
-			pal[count] = clr;
-			count++;
-		}
-		
-		if(count >= 512){
-			break;
-		}
-	}
-	
-	if(opt == AGMV_OPT_I || opt == AGMV_OPT_GBA_I || opt == AGMV_OPT_III || opt == AGMV_OPT_GBA_III || opt == AGMV_OPT_NDS){
-		for(n = 0; n < 512; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			if(n < 126){
-				palette0[n] = invclr;
-			}
-			else if(n >= 126 && n <= 252){
-				palette1[n-126] = invclr;
-			}
-			
-			if(n > 252 && n <= 381){
-				palette0[n-126] = invclr;
-			}
-			
-			if(n > 381 && (n-255) < 256){
-				palette1[n-255] = invclr;
-			}
-		}
-	}
-	
-	if(opt == AGMV_OPT_II || opt == AGMV_OPT_GBA_II|| opt == AGMV_OPT_ANIM){
-		for(n = 0; n < 256; n++){
-			u32 clr = pal[n];
-			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
-			
-			palette0[n] = invclr;
-		}
-	}
-	
-	free(colorgram);
 	free(histogram);
 	
 	if(AGMV_GetTotalAudioDuration(agmv) != 0){
@@ -4034,6 +4084,11 @@ void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, cons
 	AGMV_SetICP0(agmv,palette0);
 	AGMV_SetICP1(agmv,palette1);
 	
+	/* KEEP ANY THREADING THE CALLER ALREADY SET ON THEIR HANDLE */
+	if(agmv->encoder == NULL && agmv->pool == NULL){
+		AGMV_SetEncodeThreads(agmv,0);
+	}
+	
 	printf("Encoding AGMV Header...\n");
 	AGMV_EncodeHeader(file,agmv);
 	printf("Encoded AGMV Header...\n");
@@ -4369,6 +4424,8 @@ void AGMV_EncodeFullAGMV(AGMV* agmv, const char* filename, const char* dir, cons
 		}
 	}
 
+	AGMV_EncodeIndexChunk(file,agmv);
+	
 	fclose(file);
 	
 	free(ext);
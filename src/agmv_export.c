@@ -0,0 +1,145 @@
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_export.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+#include <agidl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <agmv_export.h>
+#include <agmv_thread.h>
+
+/* EACH WRITER TAKES THE OLDEST PENDING FRAME, WRITES IT OUTSIDE THE LOCK AND HANDS THE SLOT BACK TO THE DECODE THREAD */
+static void AGMV_ExportWriter(void* data){
+	AGMV_EXPORTER* exporter = (AGMV_EXPORTER*)data;
+	AGMV_EXPORT_SLOT* slot;
+
+	while(TRUE){
+		AGMV_LockMutex(exporter->lock);
+
+		while(exporter->pending_count == 0 && exporter->closed != TRUE){
+			AGMV_WaitCond(exporter->cond,exporter->lock);
+		}
+
+		if(exporter->pending_count == 0){
+			AGMV_UnlockMutex(exporter->lock);
+			break;
+		}
+
+		slot = exporter->pending[exporter->pending_head];
+		exporter->pending_head = (exporter->pending_head + 1) % exporter->capacity;
+		exporter->pending_count--;
+
+		AGMV_UnlockMutex(exporter->lock);
+
+		AGIDL_QuickExportNumbered(slot->img_data,slot->number,exporter->width,exporter->height,AGIDL_RGB_888,exporter->img_type);
+
+		AGMV_LockMutex(exporter->lock);
+		exporter->free_slots[exporter->num_of_free++] = slot;
+		AGMV_BroadcastCond(exporter->cond);
+		AGMV_UnlockMutex(exporter->lock);
+	}
+}
+
+/* NUM_OF_THREADS OF 0 USES ONE WRITER PER CORE. DEPTH IS THE NUMBER OF FRAME COPIES THAT MAY BE WAITING ON DISK AT ONCE */
+AGMV_EXPORTER* AGMV_CreateExporter(u32 width, u32 height, u8 img_type, u32 num_of_threads, u32 depth){
+	AGMV_EXPORTER* exporter = (AGMV_EXPORTER*)malloc(sizeof(AGMV_EXPORTER));
+	u32 i;
+
+	if(num_of_threads == 0){
+		num_of_threads = AGMV_GetNumberOfCores();
+	}
+
+	if(depth < num_of_threads){
+		depth = num_of_threads;
+	}
+
+	exporter->width = width;
+	exporter->height = height;
+	exporter->img_type = img_type;
+	exporter->capacity = depth;
+	exporter->num_of_free = depth;
+	exporter->pending_head = 0;
+	exporter->pending_count = 0;
+	exporter->closed = FALSE;
+	exporter->lock = AGMV_CreateMutex();
+	exporter->cond = AGMV_CreateCond();
+	exporter->slots = (AGMV_EXPORT_SLOT*)malloc(sizeof(AGMV_EXPORT_SLOT)*depth);
+	exporter->free_slots = (AGMV_EXPORT_SLOT**)malloc(sizeof(AGMV_EXPORT_SLOT*)*depth);
+	exporter->pending = (AGMV_EXPORT_SLOT**)malloc(sizeof(AGMV_EXPORT_SLOT*)*depth);
+
+	for(i = 0; i < depth; i++){
+		exporter->slots[i].number = 0;
+		exporter->slots[i].img_data = (u32*)malloc(sizeof(u32)*width*height);
+		exporter->free_slots[i] = &exporter->slots[i];
+	}
+
+	exporter->num_of_threads = num_of_threads;
+	exporter->threads = (AGMV_THREAD*)malloc(sizeof(AGMV_THREAD)*num_of_threads);
+
+	for(i = 0; i < num_of_threads; i++){
+		exporter->threads[i] = AGMV_CreateThread(AGMV_ExportWriter,exporter);
+	}
+
+	return exporter;
+}
+
+/* COPIES THE FRAME INTO A FREE SLOT AND QUEUES IT, BLOCKING ONLY WHILE EVERY SLOT IS STILL WAITING ON A WRITER */
+void AGMV_ExportFrame(AGMV_EXPORTER* exporter, const u32* img_data){
+	AGMV_EXPORT_SLOT* slot;
+
+	AGMV_LockMutex(exporter->lock);
+
+	while(exporter->num_of_free == 0){
+		AGMV_WaitCond(exporter->cond,exporter->lock);
+	}
+
+	slot = exporter->free_slots[--exporter->num_of_free];
+
+	AGMV_UnlockMutex(exporter->lock);
+
+	slot->number = AGIDL_ReserveQuickExport();
+	memcpy(slot->img_data,img_data,sizeof(u32)*exporter->width*exporter->height);
+
+	AGMV_LockMutex(exporter->lock);
+	exporter->pending[(exporter->pending_head + exporter->pending_count) % exporter->capacity] = slot;
+	exporter->pending_count++;
+	AGMV_BroadcastCond(exporter->cond);
+	AGMV_UnlockMutex(exporter->lock);
+}
+
+/* WAITS FOR EVERY QUEUED FRAME TO REACH DISK BEFORE RELEASING THE WRITERS */
+void AGMV_DestroyExporter(AGMV_EXPORTER* exporter){
+	u32 i;
+
+	if(exporter != NULL){
+		AGMV_LockMutex(exporter->lock);
+		exporter->closed = TRUE;
+		AGMV_BroadcastCond(exporter->cond);
+		AGMV_UnlockMutex(exporter->lock);
+
+		for(i = 0; i < exporter->num_of_threads; i++){
+			AGMV_JoinThread(exporter->threads[i]);
+		}
+
+		for(i = 0; i < exporter->capacity; i++){
+			free(exporter->slots[i].img_data);
+		}
+
+		AGMV_DestroyCond(exporter->cond);
+		AGMV_DestroyMutex(exporter->lock);
+		free(exporter->threads);
+		free(exporter->slots);
+		free(exporter->free_slots);
+		free(exporter->pending);
+		free(exporter);
+	}
+}
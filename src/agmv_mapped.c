@@ -0,0 +1,515 @@
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_mapped.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+#include <agidl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <agmv_mapped.h>
+#include <agmv_decode.h>
+#include <agmv_utils.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#define AGMV_USE_MMAP
+#endif
+
+/*-------MEMORY MAPPED FILE UTILITY FUNCTIONS------*/
+
+static Bool AGMV_ReadWholeFile(AGMV_MAPPED_FILE* mapped, const char* filename){
+	FILE* file = fopen(filename,"rb");
+	u8* data;
+	long len;
+
+	if(file == NULL){
+		return FALSE;
+	}
+
+	fseek(file,0,SEEK_END);
+	len = ftell(file);
+	fseek(file,0,SEEK_SET);
+
+	if(len < 0){
+		fclose(file);
+		return FALSE;
+	}
+
+	data = (u8*)malloc(len + 1);
+
+	if(data == NULL){
+		fclose(file);
+		return FALSE;
+	}
+
+	mapped->len = fread(data,1,len,file);
+	mapped->data = data;
+	mapped->mapped = FALSE;
+
+	fclose(file);
+
+	return TRUE;
+}
+
+AGMV_MAPPED_FILE* AGMV_OpenMapped(const char* filename){
+	AGMV_MAPPED_FILE* mapped = (AGMV_MAPPED_FILE*)malloc(sizeof(AGMV_MAPPED_FILE));
+
+	mapped->len = 0;
+	mapped->pos = 0;
+	mapped->data = NULL;
+	mapped->handle = NULL;
+	mapped->mapping = NULL;
+	mapped->mapped = FALSE;
+
+#if defined(_WIN32)
+	{
+		HANDLE handle, mapping;
+		DWORD high = 0, low;
+
+		handle = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+
+		if(handle == INVALID_HANDLE_VALUE){
+			free(mapped);
+			return NULL;
+		}
+
+		low = GetFileSize(handle,&high);
+
+		if(low != 0 && high == 0){
+			mapping = CreateFileMappingA(handle,NULL,PAGE_READONLY,0,0,NULL);
+
+			if(mapping != NULL){
+				mapped->data = (const u8*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+
+				if(mapped->data != NULL){
+					mapped->len = low;
+					mapped->handle = handle;
+					mapped->mapping = mapping;
+					mapped->mapped = TRUE;
+					return mapped;
+				}
+
+				CloseHandle(mapping);
+			}
+		}
+
+		CloseHandle(handle);
+	}
+#elif defined(AGMV_USE_MMAP)
+	{
+		struct stat st;
+		void* data;
+		int fd = open(filename,O_RDONLY);
+
+		if(fd < 0){
+			free(mapped);
+			return NULL;
+		}
+
+		if(fstat(fd,&st) == 0 && st.st_size > 0 && (u32)st.st_size == st.st_size){
+			data = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+
+			if(data != MAP_FAILED){
+				close(fd);
+
+				mapped->data = (const u8*)data;
+				mapped->len = st.st_size;
+				mapped->mapped = TRUE;
+				return mapped;
+			}
+		}
+
+		close(fd);
+	}
+#endif
+
+	/* NO MAPPING AVAILABLE, FALL BACK TO READING THE FILE INTO MEMORY */
+
+	if(!AGMV_ReadWholeFile(mapped,filename)){
+		free(mapped);
+		return NULL;
+	}
+
+	return mapped;
+}
+
+void AGMV_OpenMappedMemory(AGMV_MAPPED_FILE* file, const u8* data, u32 len){
+	file->len = len;
+	file->pos = 0;
+	file->data = data;
+	file->handle = NULL;
+	file->mapping = NULL;
+	file->mapped = FALSE;
+}
+
+void AGMV_CloseMapped(AGMV_MAPPED_FILE* file){
+	if(file != NULL){
+		if(file->mapped == TRUE){
+		#if defined(_WIN32)
+			UnmapViewOfFile((LPCVOID)file->data);
+			CloseHandle((HANDLE)file->mapping);
+			CloseHandle((HANDLE)file->handle);
+		#elif defined(AGMV_USE_MMAP)
+			munmap((void*)file->data,file->len);
+		#endif
+		}
+		else if(file->data != NULL){
+			free((void*)file->data);
+		}
+
+		free(file);
+	}
+}
+
+Bool AGMV_MappedEOF(AGMV_MAPPED_FILE* file){
+	if(file->pos >= file->len){
+		return TRUE;
+	}
+	else return FALSE;
+}
+
+u32 AGMV_MappedTell(AGMV_MAPPED_FILE* file){
+	return file->pos;
+}
+
+void AGMV_MappedSeek(AGMV_MAPPED_FILE* file, u32 offset, int mode){
+	if(mode == SEEK_SET){
+		file->pos = offset;
+	}
+	if(mode == SEEK_CUR){
+		file->pos += offset;
+	}
+
+	if(file->pos > file->len){
+		file->pos = file->len;
+	}
+}
+
+u8 AGMV_MappedReadByte(AGMV_MAPPED_FILE* file){
+	if(file->pos >= file->len){
+		return 0;
+	}
+
+	return file->data[file->pos++];
+}
+
+u16 AGMV_MappedReadShort(AGMV_MAPPED_FILE* file){
+	u8 lsb = AGMV_MappedReadByte(file);
+	u8 msb = AGMV_MappedReadByte(file);
+
+	return msb << 8 | lsb;
+}
+
+u32 AGMV_MappedReadLong(AGMV_MAPPED_FILE* file){
+	u32 lsb = AGMV_MappedReadByte(file);
+	u32 lsb2 = AGMV_MappedReadByte(file);
+	u32 msb1 = AGMV_MappedReadByte(file);
+	u32 msb2 = AGMV_MappedReadByte(file);
+
+	return msb2 << 24 | msb1 << 16 | lsb2 << 8 | lsb;
+}
+
+void AGMV_MappedReadFourCC(AGMV_MAPPED_FILE* file, char fourcc[4]){
+	fourcc[0] = AGMV_MappedReadByte(file);
+	fourcc[1] = AGMV_MappedReadByte(file);
+	fourcc[2] = AGMV_MappedReadByte(file);
+	fourcc[3] = AGMV_MappedReadByte(file);
+}
+
+static void AGMV_MappedFindFourCC(AGMV_MAPPED_FILE* file, char f, char o, char u, char r){
+	const u8* data = file->data, *found;
+	u32 pos = file->pos;
+
+	while(pos + 4 <= file->len){
+		found = (const u8*)memchr(data + pos,f,file->len - 3 - pos);
+
+		if(found == NULL){
+			break;
+		}
+
+		pos = found - data;
+
+		if(data[pos+1] == (u8)o && data[pos+2] == (u8)u && data[pos+3] == (u8)r){
+			file->pos = pos;
+			return;
+		}
+
+		pos++;
+	}
+
+	file->pos = file->len;
+}
+
+void AGMV_MappedFindNextFrameChunk(AGMV_MAPPED_FILE* file){
+	AGMV_MappedFindFourCC(file,'A','G','F','C');
+}
+
+void AGMV_MappedFindNextAudioChunk(AGMV_MAPPED_FILE* file){
+	AGMV_MappedFindFourCC(file,'A','G','A','C');
+}
+
+void AGMV_MappedSkipFrameChunk(AGMV_MAPPED_FILE* file){
+	u32 csize;
+
+	AGMV_MappedFindNextFrameChunk(file);
+	AGMV_MappedSeek(file,12,SEEK_CUR);
+
+	csize = AGMV_MappedReadLong(file);
+
+	AGMV_MappedSeek(file,csize,SEEK_CUR);
+}
+
+void AGMV_MappedSkipAudioChunk(AGMV_MAPPED_FILE* file){
+	u32 size;
+
+	AGMV_MappedFindNextAudioChunk(file);
+	AGMV_MappedSeek(file,4,SEEK_CUR);
+
+	size = AGMV_MappedReadLong(file);
+
+	AGMV_MappedSeek(file,size,SEEK_CUR);
+}
+
+/*-------MEMORY MAPPED DECODING FUNCTIONS------*/
+
+int AGMV_DecodeMappedHeader(AGMV_MAPPED_FILE* file, AGMV* agmv){
+
+	int i;
+
+	AGMV_MappedReadFourCC(file,agmv->header.fourcc);
+	agmv->header.num_of_frames = AGMV_MappedReadLong(file);
+	agmv->header.width = AGMV_MappedReadLong(file);
+	agmv->header.height = AGMV_MappedReadLong(file);
+
+	agmv->header.fmt = AGMV_MappedReadByte(file);
+	agmv->header.version = AGMV_MappedReadByte(file);
+	agmv->header.frames_per_second = AGMV_MappedReadLong(file);
+
+	agmv->header.total_audio_duration = AGMV_MappedReadLong(file);
+	agmv->header.sample_rate = AGMV_MappedReadLong(file);
+	agmv->header.audio_size = AGMV_MappedReadLong(file);
+	agmv->header.num_of_channels = AGMV_MappedReadShort(file);
+	agmv->header.bits_per_sample = AGMV_MappedReadShort(file);
+
+	if(!AGMV_IsCorrectFourCC(agmv->header.fourcc,'A','G','M','V') || !(agmv->header.version == 1 || agmv->header.version == 2 || agmv->header.version == 3 || agmv->header.version == 4) || agmv->header.frames_per_second >= 200
+	|| !(agmv->header.bits_per_sample == 16 || agmv->header.bits_per_sample == 8)){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	if(agmv->header.version == 1 || agmv->header.version == 3){
+		for(i = 0; i < 256; i++){
+			u8 r = AGMV_MappedReadByte(file);
+			u8 g = AGMV_MappedReadByte(file);
+			u8 b = AGMV_MappedReadByte(file);
+
+			agmv->header.palette0[i] = AGIDL_RGB(r,g,b,agmv->header.fmt);
+		}
+
+		for(i = 0; i < 256; i++){
+			u8 r = AGMV_MappedReadByte(file);
+			u8 g = AGMV_MappedReadByte(file);
+			u8 b = AGMV_MappedReadByte(file);
+
+			agmv->header.palette1[i] = AGIDL_RGB(r,g,b,agmv->header.fmt);
+		}
+	}
+	else{
+		for(i = 0; i < 256; i++){
+			u8 r = AGMV_MappedReadByte(file);
+			u8 g = AGMV_MappedReadByte(file);
+			u8 b = AGMV_MappedReadByte(file);
+
+			agmv->header.palette0[i] = AGIDL_RGB(r,g,b,agmv->header.fmt);
+		}
+	}
+
+	agmv->header.index_offset = 0;
+
+	if(file->pos + 8 <= file->len && memcmp(file->data + file->pos,"AGIP",4) == 0){
+		file->pos += 4;
+		agmv->header.index_offset = AGMV_MappedReadLong(file);
+	}
+
+	return NO_ERR;
+}
+
+int AGMV_LoadMappedIndex(AGMV_MAPPED_FILE* file, AGMV* agmv){
+	u32 pos = file->pos, count, i;
+	char fourcc[4];
+
+	if(agmv->header.index_offset == 0 || agmv->header.index_offset >= file->len){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	file->pos = agmv->header.index_offset;
+
+	AGMV_MappedReadFourCC(file,fourcc);
+	count = AGMV_MappedReadLong(file);
+
+	if(!AGMV_IsCorrectFourCC(fourcc,'A','G','I','C') || count == 0 || count > (file->len - file->pos) / AGMV_INDEX_ENTRY_SIZE){
+		file->pos = pos;
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	AGMV_ReserveIndexEntry(agmv,count-1);
+	agmv->index->len = count;
+
+	for(i = 0; i < count; i++){
+		AGMV_INDEX_ENTRY* entry = &agmv->index->entries[i];
+		entry->frame_offset = AGMV_MappedReadLong(file);
+		entry->audio_offset = AGMV_MappedReadLong(file);
+		entry->flags = AGMV_MappedReadByte(file);
+	}
+
+	agmv->index->loaded = TRUE;
+
+	file->pos = pos;
+
+	return NO_ERR;
+}
+
+int AGMV_ReadMappedFrameChunk(AGMV_MAPPED_FILE* file, AGMV* agmv, const u8** payload, u32* csize){
+	u32 start;
+
+	AGMV_MappedReadFourCC(file,agmv->frame_chunk->fourcc);
+	agmv->frame_chunk->frame_num = AGMV_MappedReadLong(file);
+	agmv->frame_chunk->uncompressed_size = AGMV_MappedReadLong(file);
+	agmv->frame_chunk->compressed_size = AGMV_MappedReadLong(file);
+
+	if(!AGMV_IsCorrectFourCC(agmv->frame_chunk->fourcc,'A','G','F','C')){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	start = file->pos;
+	*csize = agmv->frame_chunk->compressed_size;
+
+	if(*csize > file->len - start){
+		*csize = file->len - start;
+	}
+
+	*payload = file->data + start;
+	file->pos += *csize;
+
+	return NO_ERR;
+}
+
+int AGMV_DecodeMappedFrameChunk(AGMV_MAPPED_FILE* file, AGMV* agmv){
+	const u8* payload;
+	u32 csize;
+	int err = AGMV_ReadMappedFrameChunk(file,agmv,&payload,&csize);
+
+	if(err != NO_ERR){
+		return err;
+	}
+
+	return AGMV_DecodeFramePayload(agmv,payload,csize);
+}
+
+int AGMV_DecodeMappedFrameChunkToCanvas(AGMV_MAPPED_FILE* file, AGMV* agmv, AGMV_CANVAS* canvas, void* pixels, u32 stride){
+	const u8* payload;
+	u32 csize;
+	int err = AGMV_ReadMappedFrameChunk(file,agmv,&payload,&csize);
+
+	if(err != NO_ERR){
+		return err;
+	}
+
+	return AGMV_DecodeFramePayloadToCanvas(agmv,canvas,payload,csize,pixels,stride);
+}
+
+int AGMV_DecodeMappedFrameChunkPreview(AGMV_MAPPED_FILE* file, AGMV* agmv, u32* preview){
+	const u8* payload;
+	u32 csize;
+	int err = AGMV_ReadMappedFrameChunk(file,agmv,&payload,&csize);
+
+	if(err != NO_ERR){
+		return err;
+	}
+
+	return AGMV_DecodeFramePayloadPreview(agmv,payload,csize,preview);
+}
+
+int AGMV_DecodeMappedAudioChunk(AGMV_MAPPED_FILE* file, AGMV* agmv){
+	u32 size, start, avail;
+	u8* payload;
+
+	AGMV_MappedReadFourCC(file,agmv->audio_chunk->fourcc);
+	agmv->audio_chunk->size = AGMV_MappedReadLong(file);
+
+	if(!AGMV_IsCorrectFourCC(agmv->audio_chunk->fourcc,'A','G','A','C')){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	start = file->pos;
+	size = agmv->audio_chunk->size;
+	avail = file->len - start;
+
+	if(size <= avail){
+		file->pos += size;
+		return AGMV_DecodeAudioPayload(agmv,file->data + start,size);
+	}
+
+	/* truncated chunk, samples past the end of the file read back as EOF (0xFF) */
+
+	payload = AGMV_ResizeBitstream(agmv->payload,size);
+	memcpy(payload,file->data + start,avail);
+	memset(payload + avail,0xFF,size - avail);
+
+	file->pos = file->len;
+
+	return AGMV_DecodeAudioPayload(agmv,payload,size);
+}
+
+/* ON BUFFER_FULL_ERR THE FILE IS LEFT AT THE START OF THE CHUNK, SO THE CALLER CAN DRAIN THE RING AND TRY AGAIN */
+int AGMV_DecodeMappedAudioChunkToRing(AGMV_MAPPED_FILE* file, AGMV* agmv, AGMV_AUDIO_RING* ring, u32* num_of_samples){
+	u32 size, start, avail, pos = file->pos;
+	u8* payload;
+
+	if(num_of_samples != NULL){
+		*num_of_samples = 0;
+	}
+
+	AGMV_MappedReadFourCC(file,agmv->audio_chunk->fourcc);
+	agmv->audio_chunk->size = AGMV_MappedReadLong(file);
+
+	if(!AGMV_IsCorrectFourCC(agmv->audio_chunk->fourcc,'A','G','A','C')){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+
+	start = file->pos;
+	size = agmv->audio_chunk->size;
+	avail = file->len - start;
+
+	if(size > AGMV_GetAudioRingSpace(ring)){
+		file->pos = pos;
+		return BUFFER_FULL_ERR;
+	}
+
+	if(size <= avail){
+		file->pos += size;
+		return AGMV_DecodeAudioPayloadToRing(agmv,file->data + start,size,ring,num_of_samples);
+	}
+
+	/* truncated chunk, samples past the end of the file read back as EOF (0xFF) */
+
+	payload = AGMV_ResizeBitstream(agmv->payload,size);
+	memcpy(payload,file->data + start,avail);
+	memset(payload + avail,0xFF,size - avail);
+
+	file->pos = file->len;
+
+	return AGMV_DecodeAudioPayloadToRing(agmv,payload,size,ring,num_of_samples);
+}
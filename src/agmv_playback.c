@@ -11,17 +11,13 @@
 *   Author: Ryandracus Chapman
 *
 ********************************************/
+#include <string.h>
 #include <agmv_playback.h>
 #include <agmv_utils.h>
 #include <agmv_decode.h>
 
 void AGMV_ResetVideo(FILE* file, AGMV* agmv){
-	if(AGMV_GetVersion(agmv) == 1){
-		fseek(file,1574,SEEK_SET);
-	}
-	else{
-		fseek(file,806,SEEK_SET);
-	}
+	fseek(file,AGMV_GetHeaderSize(agmv),SEEK_SET);
 	agmv->frame_count = 0;
 }
 
@@ -38,7 +34,7 @@ void AGMV_SkipForwards(FILE* file, AGMV* agmv, int n){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 			AGMV_FindNextAudioChunk(file);
 			AGMV_SkipAudioChunk(file);
@@ -49,7 +45,7 @@ void AGMV_SkipForwards(FILE* file, AGMV* agmv, int n){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 		}
 	}
@@ -61,7 +57,7 @@ void AGMV_SkipForwardsAndDecodeAudio(FILE* file, AGMV* agmv, int n){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 			AGMV_FindNextAudioChunk(file);
 			AGMV_DecodeAudioChunk(file,agmv);
@@ -72,7 +68,7 @@ void AGMV_SkipForwardsAndDecodeAudio(FILE* file, AGMV* agmv, int n){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 		}
 	}
@@ -83,33 +79,156 @@ void AGMV_SkipBackwards(FILE* file, AGMV* agmv, int n){
 	int frame_count = agmv->frame_count;
 	frame_count -= n;
 	if(frame_count < 0){
-		agmv->frame_count = 0;
+		frame_count = 0;
 	}
 	agmv->frame_count = frame_count;
-	fseek(file,agmv->offset_table[agmv->frame_count],SEEK_SET);
+	fseek(file,AGMV_GetFrameOffset(file,agmv,agmv->frame_count),SEEK_SET);
 }
 
-/* ONLY CALL SKIP TO FUNCTION AFTER ALL FRAMES HAVE BEEN READ */
+u32 AGMV_GetFrameOffset(FILE* file, AGMV* agmv, u32 n){
+	if(agmv->header.index_offset != 0 && (agmv->index == NULL || agmv->index->loaded == FALSE)){
+		if(AGMV_LoadIndex(file,agmv) != NO_ERR){
+			agmv->header.index_offset = 0;
+		}
+	}
+	
+	if(agmv->index != NULL && n < agmv->index->len){
+		return agmv->index->entries[n].frame_offset;
+	}
+	
+	return 0;
+}
+
+/* WITHOUT A SEEK INDEX, ONLY CALL SKIP TO FUNCTION AFTER ALL FRAMES HAVE BEEN READ */
 
 void AGMV_SkipTo(FILE* file, AGMV* agmv, int n){
 	n = AGMV_SkipToNearestIFrame(n);
 	if(n >= 0 && n < AGMV_GetNumberOfFrames(agmv)){
-		fseek(file,agmv->offset_table[n],SEEK_SET);
+		fseek(file,AGMV_GetFrameOffset(file,agmv,n),SEEK_SET);
 		agmv->frame_count = n;
 	}
 }
 
+/* DECODES THE FRAME CHUNK AT THE RECORDED OFFSET OF FRAME N ON TOP OF WHATEVER AGMV->FRAME HOLDS. COMPLETE IS SET TO FALSE IF THE
+   FRAME ESCAPED BEFORE DRAWING EVERY BLOCK, I.E. PART OF IT STILL SHOWS THE FRAME THAT WAS DECODED BEFORE IT */
+static int AGMV_DecodeFrameAt(FILE* file, AGMV* agmv, u32 n, Bool* complete){
+	u32 offset = AGMV_GetFrameOffset(file,agmv,n), stride = agmv->frame->width * sizeof(u32), csize, bpos;
+	int err;
+	
+	if(offset == 0){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	fseek(file,offset,SEEK_SET);
+	err = AGMV_ReadFrameChunk(file,agmv,&csize);
+	
+	if(err != NO_ERR){
+		return err;
+	}
+	
+	bpos = AGMV_DecompressFrame(agmv,agmv->payload->data,csize);
+	*complete = AGMV_RenderFrame(agmv,agmv->bitstream->data,bpos,(u8*)agmv->frame->img_data,stride,sizeof(u32),agmv->header.palette0,agmv->header.palette1,(const u8*)agmv->iframe->img_data,stride);
+	
+	/* AN I-FRAME DRAWS THE SAME BLOCKS WHATEVER CAME BEFORE IT, SO REMEMBER WHETHER IT IS CLEAN FOR THE NEXT SEEK */
+	if(n % 4 == 0){
+		memcpy(agmv->iframe->img_data,agmv->frame->img_data,stride*agmv->frame->height);
+		agmv->index->entries[n].flags |= AGMV_INDEX_CHECKED | (*complete == TRUE ? AGMV_INDEX_CLEAN : 0);
+	}
+	
+	agmv->frame_count = n + 1;
+	
+	return NO_ERR;
+}
+
+/* FRAME EXACT SEEK. P-FRAMES ONLY COPY FROM THEIR GROUP'S I-FRAME, BUT BLOCKS LEFT UNDRAWN BY AN EARLY ESCAPE KEEP THE PREVIOUS
+   FRAME'S PIXELS, SO FRAME N IS REBUILT BY DECODING FORWARD FROM THE NEAREST CLEAN I-FRAME AT OR BEFORE IT, OR FROM FRAME 0 ON TOP
+   OF THE ZEROED FRAMES A FRESH DECODE STARTS FROM. AN ENCODER WRITTEN INDEX MARKS THE CLEAN I-FRAMES, SO THE SEARCH COSTS
+   NOTHING AND THE SEEK DECODES N-START+1 FRAMES. OLDER FILES TRIAL DECODE EACH EARLIER I-FRAME NOT SEEN YET. EITHER WAY THE WORST
+   CASE, NO CLEAN I-FRAME BEFORE N, DECODES EVERY FRAME FROM 0 TO N. ON RETURN AGMV->FRAME HOLDS FRAME N AND PLAYBACK CONTINUES
+   WITH FRAME N+1, EXACTLY AS IF EVERY FRAME UP TO N HAD BEEN DECODED IN ORDER */
+
+/* WITHOUT A SEEK INDEX, ONLY CALL SEEK TO FRAME AFTER ALL FRAMES HAVE BEEN READ */
+
+int AGMV_SeekToFrame(FILE* file, AGMV* agmv, u32 n){
+	u32 num_of_frames = AGMV_GetNumberOfFrames(agmv), size = agmv->frame->width*agmv->frame->height, start, i;
+	Bool complete, decoded = FALSE;
+	u8 flags;
+	int err;
+	
+	if(num_of_frames == 0){
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	if(n >= num_of_frames){
+		n = num_of_frames - 1;
+	}
+	
+	start = n - n % 4;
+	
+	while(start > 0){
+		/* ALSO LOADS THE FILE'S INDEX THE FIRST TIME */
+		if(AGMV_GetFrameOffset(file,agmv,start) == 0){
+			return INVALID_HEADER_FORMATTING_ERR;
+		}
+		
+		flags = agmv->index->entries[start].flags;
+		
+		if(flags & AGMV_INDEX_CHECKED){
+			if(flags & AGMV_INDEX_CLEAN){
+				break;
+			}
+		}
+		else{
+			err = AGMV_DecodeFrameAt(file,agmv,start,&complete);
+			
+			if(err != NO_ERR){
+				return err;
+			}
+			
+			if(complete == TRUE){
+				decoded = TRUE;
+				break;
+			}
+		}
+		
+		start -= 4;
+	}
+	
+	if(start == 0){
+		memset(agmv->frame->img_data,0,sizeof(u32)*size);
+		memset(agmv->iframe->img_data,0,sizeof(u32)*size);
+	}
+	
+	if(decoded != TRUE){
+		err = AGMV_DecodeFrameAt(file,agmv,start,&complete);
+		
+		if(err != NO_ERR){
+			return err;
+		}
+	}
+	
+	for(i = start + 1; i <= n; i++){
+		err = AGMV_DecodeFrameAt(file,agmv,i,&complete);
+		
+		if(err != NO_ERR){
+			return err;
+		}
+	}
+	
+	return NO_ERR;
+}
+
 void AGMV_PlayAGMV(FILE* file, AGMV* agmv){
 	if(AGMV_GetTotalAudioDuration(agmv) != 0){
 		AGMV_FindNextFrameChunk(file);
-		agmv->offset_table[agmv->frame_count] = ftell(file);
+		AGMV_RecordFrameOffset(agmv,agmv->frame_count,ftell(file));
 		AGMV_DecodeFrameChunk(file,agmv);
 		AGMV_FindNextAudioChunk(file);
 		AGMV_SkipAudioChunk(file);
 	}
 	else{
 		AGMV_FindNextFrameChunk(file);
-		agmv->offset_table[agmv->frame_count] = ftell(file);
+		AGMV_RecordFrameOffset(agmv,agmv->frame_count,ftell(file));
 		AGMV_DecodeFrameChunk(file,agmv);
 	}
 }
@@ -120,15 +239,109 @@ void PlotPixel(u32* vram, int x, int y, int w, int h, u32 color){
 	}
 }
 
-void AGMV_DisplayFrame(u32* vram, u16 width, u16 height, AGMV* agmv){
-	u32 fwidth = agmv->frame->width, fheight = agmv->frame->height, offset;
-	u32* img_data = agmv->frame->img_data;
-	
-	int x,y;
-	for(y = 0; y < fheight; y++){
-		offset = y * fwidth;
-		for(x = 0; x < fwidth; x++){
-			PlotPixel(vram,x,y,width,height,img_data[x+offset]);
+/* CLIPS THE DESTINATION RECTANGLE ONCE, THEN WRITES EACH SOURCE ROW A SINGLE TIME AND COPIES IT DOWN FOR THE REMAINING SCALE-1 ROWS */
+void AGMV_BlitFrame(u32* vram, u32 width, u32 height, AGMV* agmv, int x, int y, u32 scale){
+	const u32* img_data = agmv->frame->img_data, *src;
+	u32 fwidth = agmv->frame->width, fheight = agmv->frame->height;
+	long x0, x1, y0, y1, dy, dx, first;
+	u32 sx, rep, run;
+	u32* dest;
+
+	if(scale == 0){
+		scale = 1;
+	}
+
+	x0 = x < 0 ? 0 : x;
+	y0 = y < 0 ? 0 : y;
+	x1 = (long)x + (long)(fwidth*scale);
+	y1 = (long)y + (long)(fheight*scale);
+
+	if(x1 > (long)width){
+		x1 = width;
+	}
+
+	if(y1 > (long)height){
+		y1 = height;
+	}
+
+	if(x0 >= x1 || y0 >= y1){
+		return;
+	}
+
+	run = x1 - x0;
+
+	if(scale == 1){
+		for(dy = y0; dy < y1; dy++){
+			memcpy(vram + x0 + dy*width,img_data + (x0 - x) + (dy - y)*fwidth,run*sizeof(u32));
+		}
+		return;
+	}
+
+	for(dy = y0; dy < y1; dy = first + scale){
+		first = y + ((dy - y)/scale)*scale;
+		src = img_data + ((dy - y)/scale)*fwidth;
+		dest = vram + x0 + dy*width;
+		sx = (x0 - x)/scale;
+		rep = (x0 - x)%scale;
+
+		for(dx = 0; dx < (long)run; dx++){
+			dest[dx] = src[sx];
+
+			if(++rep == scale){
+				rep = 0;
+				sx++;
+			}
+		}
+
+		for(dx = dy + 1; dx < first + scale && dx < y1; dx++){
+			memcpy(vram + x0 + dx*width,dest,run*sizeof(u32));
+		}
+	}
+}
+
+static void AGMV_FillRect(u32* vram, u32 width, long x0, long y0, long x1, long y1, u32 color){
+	long x, y;
+	u32* row;
+
+	for(y = y0; y < y1; y++){
+		row = vram + y*width;
+		for(x = x0; x < x1; x++){
+			row[x] = color;
 		}
 	}
-}
\ No newline at end of file
+}
+
+/* CENTERS THE FRAME AT THE LARGEST WHOLE SCALE THAT FITS AND PAINTS ONLY THE BORDERS AROUND IT. RETURNS THE SCALE USED */
+u32 AGMV_LetterboxFrame(u32* vram, u32 width, u32 height, AGMV* agmv, u32 border_color){
+	u32 fwidth = agmv->frame->width, fheight = agmv->frame->height, scale = 1;
+	long x, y, x1, y1, top, bottom;
+
+	if(fwidth != 0 && fheight != 0){
+		scale = width/fwidth < height/fheight ? width/fwidth : height/fheight;
+	}
+
+	if(scale == 0){
+		scale = 1;
+	}
+
+	x = ((long)width - (long)(fwidth*scale))/2;
+	y = ((long)height - (long)(fheight*scale))/2;
+
+	x1 = x + fwidth*scale;
+	y1 = y + fheight*scale;
+	top = y > 0 ? y : 0;
+	bottom = y1 < (long)height ? y1 : height;
+
+	AGMV_FillRect(vram,width,0,0,width,top,border_color);
+	AGMV_FillRect(vram,width,0,bottom,width,height,border_color);
+	AGMV_FillRect(vram,width,0,top,x > 0 ? x : 0,bottom,border_color);
+	AGMV_FillRect(vram,width,x1 < (long)width ? x1 : width,top,width,bottom,border_color);
+
+	AGMV_BlitFrame(vram,width,height,agmv,x,y,scale);
+
+	return scale;
+}
+
+void AGMV_DisplayFrame(u32* vram, u16 width, u16 height, AGMV* agmv){
+	AGMV_BlitFrame(vram,width,height,agmv,0,0,1);
+}
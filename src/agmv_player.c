@@ -0,0 +1,228 @@
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_player.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <agmv_player.h>
+#include <agmv_decode.h>
+#include <agmv_utils.h>
+#include <agmv_thread.h>
+
+/* THE READER ONLY TOUCHES THE FILE AND THE PACKET RING, SO A SLOW READ NEVER STALLS A DECODE IN PROGRESS */
+static void AGMV_PlayerReader(void* data){
+	AGMV_PLAYER* player = (AGMV_PLAYER*)data;
+	AGMV_PACKET* packet;
+	FILE* file = player->file;
+	Bool has_audio = player->agmv->header.total_audio_duration != 0;
+	u32 num_of_frames = player->agmv->header.num_of_frames, i;
+	char fourcc[4];
+
+	for(i = 0; i < num_of_frames && AGMV_AtomicLoad(&player->quit) != TRUE; i++){
+		AGMV_FindNextFrameChunk(file);
+
+		if(AGMV_EOF(file)){
+			break;
+		}
+
+		packet = (AGMV_PACKET*)AGMV_RingBeginWrite(player->packets,TRUE);
+
+		if(packet == NULL){
+			break;
+		}
+
+		AGMV_ReadFourCC(file,fourcc);
+		packet->frame_num = AGMV_ReadLong(file);
+		packet->uncompressed_size = AGMV_ReadLong(file);
+		packet->compressed_size = AGMV_ReadLong(file);
+
+		if(!AGMV_IsCorrectFourCC(fourcc,'A','G','F','C')){
+			AGMV_AtomicStore(&player->error,INVALID_HEADER_FORMATTING_ERR);
+			break;
+		}
+
+		if(packet->data == NULL || packet->capacity < packet->compressed_size + 1){
+			free(packet->data);
+			packet->capacity = packet->compressed_size + 1;
+			packet->data = (u8*)malloc(packet->capacity);
+		}
+
+		packet->compressed_size = fread(packet->data,1,packet->compressed_size,file);
+
+		AGMV_RingEndWrite(player->packets);
+
+		if(has_audio){
+			AGMV_FindNextAudioChunk(file);
+			AGMV_SkipAudioChunk(file);
+		}
+	}
+
+	AGMV_CloseRing(player->packets);
+}
+
+/* THE DECODER OWNS PLAYER->AGMV. FRAMES ARE COPIED OUT RATHER THAN DECODED IN PLACE BECAUSE A FRAME THAT ESCAPES
+   EARLY KEEPS THE PREVIOUS FRAME'S PIXELS, SO THE DECODER MUST ALWAYS RENDER OVER ITS OWN LAST FRAME */
+static void AGMV_PlayerDecoder(void* data){
+	AGMV_PLAYER* player = (AGMV_PLAYER*)data;
+	AGMV* agmv = player->agmv;
+	AGMV_PACKET* packet;
+	AGMV_DECODED_FRAME* frame;
+	u32 size = agmv->frame->width*agmv->frame->height;
+
+	while(AGMV_AtomicLoad(&player->quit) != TRUE){
+		packet = (AGMV_PACKET*)AGMV_RingBeginRead(player->packets,TRUE);
+
+		if(packet == NULL){
+			break;
+		}
+
+		frame = (AGMV_DECODED_FRAME*)AGMV_RingBeginWrite(player->frames,TRUE);
+
+		if(frame == NULL){
+			break;
+		}
+
+		agmv->frame_chunk->frame_num = packet->frame_num;
+		agmv->frame_chunk->uncompressed_size = packet->uncompressed_size;
+		agmv->frame_chunk->compressed_size = packet->compressed_size;
+
+		AGMV_DecodeFramePayload(agmv,packet->data,packet->compressed_size);
+
+		AGMV_RingEndRead(player->packets);
+
+		frame->frame_num = agmv->frame_count-1;
+		memcpy(frame->img_data,agmv->frame->img_data,sizeof(u32)*size);
+
+		AGMV_RingEndWrite(player->frames);
+	}
+
+	AGMV_CloseRing(player->frames);
+}
+
+AGMV_PLAYER* AGMV_OpenPlayer(const char* filename, u32 num_of_frames, AGMV_PRESENT_FUNC present, void* userdata){
+	AGMV_PLAYER* player;
+	AGMV* agmv;
+	FILE* file = fopen(filename,"rb");
+	u32 size, i;
+
+	if(file == NULL){
+		return NULL;
+	}
+
+	agmv = AGMV_AllocDecoder();
+
+	if(AGMV_DecodeHeader(file,agmv) != NO_ERR){
+		fclose(file);
+		DestroyAGMV(agmv);
+		return NULL;
+	}
+
+	if(num_of_frames < 2){
+		num_of_frames = 2;
+	}
+
+	size = agmv->header.width*agmv->header.height;
+
+	agmv->frame->width = agmv->header.width;
+	agmv->frame->height = agmv->header.height;
+	agmv->frame->img_data = (u32*)calloc(size,sizeof(u32));
+
+	agmv->iframe->width = agmv->header.width;
+	agmv->iframe->height = agmv->header.height;
+	agmv->iframe->img_data = (u32*)calloc(size,sizeof(u32));
+
+	AGMV_ResizeBitstream(agmv->bitstream,size*2);
+
+	player = (AGMV_PLAYER*)malloc(sizeof(AGMV_PLAYER));
+	player->file = file;
+	player->agmv = agmv;
+	player->present = present;
+	player->userdata = userdata;
+	player->quit = FALSE;
+	player->error = NO_ERR;
+
+	/* THE PACKET RING IS THE SAME DEPTH AS THE FRAME RING SO A BURST OF SMALL P-FRAMES CAN BE READ AHEAD OF A LARGE I-FRAME */
+	player->packets = AGMV_CreateRing(num_of_frames);
+	player->frames = AGMV_CreateRing(num_of_frames);
+	player->packet_slots = (AGMV_PACKET*)calloc(num_of_frames,sizeof(AGMV_PACKET));
+	player->frame_slots = (AGMV_DECODED_FRAME*)calloc(num_of_frames,sizeof(AGMV_DECODED_FRAME));
+
+	for(i = 0; i < num_of_frames; i++){
+		player->frame_slots[i].width = agmv->header.width;
+		player->frame_slots[i].height = agmv->header.height;
+		player->frame_slots[i].img_data = (u32*)malloc(sizeof(u32)*size);
+		player->packets->slots[i] = &player->packet_slots[i];
+		player->frames->slots[i] = &player->frame_slots[i];
+	}
+
+	player->reader = AGMV_CreateThread(AGMV_PlayerReader,player);
+	player->decoder = AGMV_CreateThread(AGMV_PlayerDecoder,player);
+
+	return player;
+}
+
+/* HANDS THE OLDEST DECODED FRAME TO THE PRESENT CALLBACK. WITHOUT WAIT THIS NEVER BLOCKS, SO IT CAN BE CALLED
+   ONCE PER TICK FROM A RENDER LOOP AND SIMPLY RETURNS FALSE WHEN THE DECODER HAS FALLEN BEHIND */
+Bool AGMV_PlayerPresent(AGMV_PLAYER* player, Bool wait){
+	AGMV_DECODED_FRAME* frame = (AGMV_DECODED_FRAME*)AGMV_RingBeginRead(player->frames,wait);
+
+	if(frame == NULL){
+		return FALSE;
+	}
+
+	if(player->present != NULL){
+		player->present(player->userdata,frame);
+	}
+
+	AGMV_RingEndRead(player->frames);
+
+	return TRUE;
+}
+
+u32 AGMV_GetPlayerBufferedFrames(AGMV_PLAYER* player){
+	return AGMV_RingCount(player->frames);
+}
+
+Bool AGMV_IsPlayerDone(AGMV_PLAYER* player){
+	return AGMV_IsRingDrained(player->frames);
+}
+
+int AGMV_GetPlayerError(AGMV_PLAYER* player){
+	return AGMV_AtomicLoad(&player->error);
+}
+
+void AGMV_ClosePlayer(AGMV_PLAYER* player){
+	u32 i;
+
+	if(player != NULL){
+		AGMV_AtomicStore(&player->quit,TRUE);
+		AGMV_CloseRing(player->packets);
+		AGMV_CloseRing(player->frames);
+
+		AGMV_JoinThread(player->reader);
+		AGMV_JoinThread(player->decoder);
+
+		for(i = 0; i < player->frames->capacity; i++){
+			free(player->packet_slots[i].data);
+			free(player->frame_slots[i].img_data);
+		}
+
+		AGMV_DestroyRing(player->packets);
+		AGMV_DestroyRing(player->frames);
+		free(player->packet_slots);
+		free(player->frame_slots);
+
+		fclose(player->file);
+		DestroyAGMV(player->agmv);
+		free(player);
+	}
+}
@@ -0,0 +1,448 @@
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_simd.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+#include <string.h>
+#include <agmv_simd.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define AGMV_HAS_SSE2
+	#include <emmintrin.h>
+	#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+		#define AGMV_HAS_AVX2
+		#include <immintrin.h>
+		#if defined(_MSC_VER)
+			#include <intrin.h>
+			#define AGMV_AVX2_TARGET
+		#else
+			#define AGMV_AVX2_TARGET __attribute__((target("avx2")))
+		#endif
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+	#define AGMV_HAS_NEON
+	#include <arm_neon.h>
+#endif
+
+/*-------SCALAR KERNELS------*/
+
+static void AGMV_StorePixel(u8* dest, u32 bpp, u32 color){
+	if(bpp == sizeof(u32)){
+		*(u32*)dest = color;
+		return;
+	}
+	switch(bpp){
+		case 4: *(unsigned int*)dest = color; break;
+		case 2: *(u16*)dest = color; break;
+		default: *dest = color; break;
+	}
+}
+
+static void AGMV_FillBlockScalar(u8* dest, u32 stride, u32 bpp, u32 color){
+	u8 row[32];
+	int i,j;
+
+	for(i = 0; i < 4; i++){
+		AGMV_StorePixel(row + i*bpp,bpp,color);
+	}
+
+	for(j = 0; j < 4; j++, dest += stride){
+		memcpy(dest,row,4*bpp);
+	}
+}
+
+static void AGMV_CopyBlockScalar(u8* dest, u32 stride, const u8* src, u32 src_stride, u32 bpp){
+	int j;
+	for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+		memcpy(dest,src,4*bpp);
+	}
+}
+
+static void AGMV_GatherBlockScalar(u8* dest, u32 stride, u32 bpp, const u8* indices, const u8* lut){
+	int i,j;
+	for(j = 0; j < 4; j++, dest += stride, indices += 4){
+		for(i = 0; i < 4; i++){
+			memcpy(dest + i*bpp,lut + indices[i]*bpp,bpp);
+		}
+	}
+}
+
+static Bool AGMV_EscapesScalar(const u8* indices){
+	int i;
+	for(i = 0; i < 16; i++){
+		if((indices[i] & 0x7f) == 127){
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static const AGMV_BLOCK_KERNELS scalar_kernels = {
+	AGMV_FillBlockScalar,
+	AGMV_CopyBlockScalar,
+	AGMV_GatherBlockScalar,
+	AGMV_EscapesScalar,
+};
+
+/*-------SSE2 KERNELS------*/
+
+#ifdef AGMV_HAS_SSE2
+/* ONE BLOCK ROW IS 8, 16 OR 32 BYTES FOR 2, 4 AND 8 BYTE PIXELS, SO EVERY ROW IS AT MOST TWO 128-BIT STORES */
+static void AGMV_FillBlockSSE2(u8* dest, u32 stride, u32 bpp, u32 color){
+	__m128i v;
+	int j;
+
+	switch(bpp){
+		case 8:{
+			v = _mm_set1_epi64x((long long)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				_mm_storeu_si128((__m128i*)dest,v);
+				_mm_storeu_si128((__m128i*)(dest+16),v);
+			}
+		}break;
+		case 4:{
+			v = _mm_set1_epi32((int)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				_mm_storeu_si128((__m128i*)dest,v);
+			}
+		}break;
+		case 2:{
+			v = _mm_set1_epi16((short)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				_mm_storel_epi64((__m128i*)dest,v);
+			}
+		}break;
+		default:{
+			AGMV_FillBlockScalar(dest,stride,bpp,color);
+		}break;
+	}
+}
+
+static void AGMV_CopyBlockSSE2(u8* dest, u32 stride, const u8* src, u32 src_stride, u32 bpp){
+	int j;
+
+	switch(bpp){
+		case 8:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				__m128i lo = _mm_loadu_si128((const __m128i*)src);
+				__m128i hi = _mm_loadu_si128((const __m128i*)(src+16));
+				_mm_storeu_si128((__m128i*)dest,lo);
+				_mm_storeu_si128((__m128i*)(dest+16),hi);
+			}
+		}break;
+		case 4:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				_mm_storeu_si128((__m128i*)dest,_mm_loadu_si128((const __m128i*)src));
+			}
+		}break;
+		case 2:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				_mm_storel_epi64((__m128i*)dest,_mm_loadl_epi64((const __m128i*)src));
+			}
+		}break;
+		default:{
+			AGMV_CopyBlockScalar(dest,stride,src,src_stride,bpp);
+		}break;
+	}
+}
+
+static Bool AGMV_EscapesSSE2(const u8* indices){
+	__m128i v = _mm_loadu_si128((const __m128i*)indices);
+	v = _mm_and_si128(v,_mm_set1_epi8(0x7f));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(v,_mm_set1_epi8(0x7f))) != 0;
+}
+
+static const AGMV_BLOCK_KERNELS sse2_kernels = {
+	AGMV_FillBlockSSE2,
+	AGMV_CopyBlockSSE2,
+	AGMV_GatherBlockScalar,
+	AGMV_EscapesSSE2,
+};
+#endif
+
+/*-------AVX2 KERNELS------*/
+
+#ifdef AGMV_HAS_AVX2
+AGMV_AVX2_TARGET static void AGMV_FillBlockAVX2(u8* dest, u32 stride, u32 bpp, u32 color){
+	int j;
+
+	if(bpp == 8){
+		__m256i v = _mm256_set1_epi64x((long long)color);
+		for(j = 0; j < 4; j++, dest += stride){
+			_mm256_storeu_si256((__m256i*)dest,v);
+		}
+	}
+	else{
+		AGMV_FillBlockSSE2(dest,stride,bpp,color);
+	}
+}
+
+AGMV_AVX2_TARGET static void AGMV_CopyBlockAVX2(u8* dest, u32 stride, const u8* src, u32 src_stride, u32 bpp){
+	int j;
+
+	if(bpp == 8){
+		for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+			_mm256_storeu_si256((__m256i*)dest,_mm256_loadu_si256((const __m256i*)src));
+		}
+	}
+	else{
+		AGMV_CopyBlockSSE2(dest,stride,src,src_stride,bpp);
+	}
+}
+
+/* HARDWARE GATHER STRAIGHT FROM THE LUT, TWO ROWS PER GATHER FOR 4 BYTE PIXELS AND ONE ROW PER GATHER FOR 8 BYTE PIXELS */
+AGMV_AVX2_TARGET static void AGMV_GatherBlockAVX2(u8* dest, u32 stride, u32 bpp, const u8* indices, const u8* lut){
+	__m256i idx;
+	int j;
+
+	if(bpp == 4){
+		for(j = 0; j < 4; j += 2, dest += 2*stride, indices += 8){
+			idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)indices));
+			idx = _mm256_i32gather_epi32((const int*)lut,idx,4);
+			_mm_storeu_si128((__m128i*)dest,_mm256_castsi256_si128(idx));
+			_mm_storeu_si128((__m128i*)(dest+stride),_mm256_extracti128_si256(idx,1));
+		}
+	}
+	else if(bpp == 8){
+		for(j = 0; j < 4; j++, dest += stride, indices += 4){
+			int packed;
+			memcpy(&packed,indices,4);
+			__m128i i4 = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+			_mm256_storeu_si256((__m256i*)dest,_mm256_i32gather_epi64((const long long*)lut,i4,8));
+		}
+	}
+	else{
+		AGMV_GatherBlockScalar(dest,stride,bpp,indices,lut);
+	}
+}
+
+static const AGMV_BLOCK_KERNELS avx2_kernels = {
+	AGMV_FillBlockAVX2,
+	AGMV_CopyBlockAVX2,
+	AGMV_GatherBlockAVX2,
+	AGMV_EscapesSSE2,
+};
+#endif
+
+/*-------NEON KERNELS------*/
+
+#ifdef AGMV_HAS_NEON
+static void AGMV_FillBlockNEON(u8* dest, u32 stride, u32 bpp, u32 color){
+	int j;
+
+	switch(bpp){
+		case 8:{
+			uint64x2_t v = vdupq_n_u64((uint64_t)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				vst1q_u64((uint64_t*)dest,v);
+				vst1q_u64((uint64_t*)(dest+16),v);
+			}
+		}break;
+		case 4:{
+			uint32x4_t v = vdupq_n_u32((uint32_t)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				vst1q_u32((uint32_t*)dest,v);
+			}
+		}break;
+		case 2:{
+			uint16x4_t v = vdup_n_u16((uint16_t)color);
+			for(j = 0; j < 4; j++, dest += stride){
+				vst1_u16((uint16_t*)dest,v);
+			}
+		}break;
+		default:{
+			AGMV_FillBlockScalar(dest,stride,bpp,color);
+		}break;
+	}
+}
+
+static void AGMV_CopyBlockNEON(u8* dest, u32 stride, const u8* src, u32 src_stride, u32 bpp){
+	int j;
+
+	switch(bpp){
+		case 8:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				vst1q_u8(dest,vld1q_u8(src));
+				vst1q_u8(dest+16,vld1q_u8(src+16));
+			}
+		}break;
+		case 4:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				vst1q_u8(dest,vld1q_u8(src));
+			}
+		}break;
+		case 2:{
+			for(j = 0; j < 4; j++, dest += stride, src += src_stride){
+				vst1_u8(dest,vld1_u8(src));
+			}
+		}break;
+		default:{
+			AGMV_CopyBlockScalar(dest,stride,src,src_stride,bpp);
+		}break;
+	}
+}
+
+static Bool AGMV_EscapesNEON(const u8* indices){
+	uint8x16_t v = vandq_u8(vld1q_u8(indices),vdupq_n_u8(0x7f));
+	uint8x16_t eq = vceqq_u8(v,vdupq_n_u8(0x7f));
+	uint64x2_t lanes = vreinterpretq_u64_u8(eq);
+	return (vgetq_lane_u64(lanes,0) | vgetq_lane_u64(lanes,1)) != 0;
+}
+
+static const AGMV_BLOCK_KERNELS neon_kernels = {
+	AGMV_FillBlockNEON,
+	AGMV_CopyBlockNEON,
+	AGMV_GatherBlockScalar,
+	AGMV_EscapesNEON,
+};
+#endif
+
+/*-------RUNTIME DISPATCH------*/
+
+static const AGMV_BLOCK_KERNELS* kernels = NULL;
+static AGMV_SIMD simd_level = AGMV_SIMD_NONE;
+
+#if defined(_WIN32)
+	static INIT_ONCE kernels_once = INIT_ONCE_STATIC_INIT;
+#else
+	static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+#endif
+
+static Bool AGMV_CPUHasAVX2(){
+#if defined(AGMV_HAS_AVX2) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info,0);
+	if(info[0] < 7){
+		return FALSE;
+	}
+	__cpuid(info,1);
+	/* OSXSAVE AND AVX, THEN CHECK THE OS SAVES THE YMM REGISTERS */
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6){
+		return FALSE;
+	}
+	__cpuidex(info,7,0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(AGMV_HAS_AVX2)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return FALSE;
+#endif
+}
+
+Bool AGMV_IsSIMDSupported(AGMV_SIMD simd){
+	switch(simd){
+		case AGMV_SIMD_NONE:{
+			return TRUE;
+		}
+	#ifdef AGMV_HAS_SSE2
+		case AGMV_SIMD_SSE2:{
+			return TRUE;
+		}
+	#endif
+	#ifdef AGMV_HAS_AVX2
+		case AGMV_SIMD_AVX2:{
+			return AGMV_CPUHasAVX2();
+		}
+	#endif
+	#ifdef AGMV_HAS_NEON
+		case AGMV_SIMD_NEON:{
+			return TRUE;
+		}
+	#endif
+		default:{
+			return FALSE;
+		}
+	}
+}
+
+static void AGMV_SelectKernels(AGMV_SIMD simd){
+	switch(simd){
+	#ifdef AGMV_HAS_SSE2
+		case AGMV_SIMD_SSE2:{
+			kernels = &sse2_kernels;
+		}break;
+	#endif
+	#ifdef AGMV_HAS_AVX2
+		case AGMV_SIMD_AVX2:{
+			kernels = &avx2_kernels;
+		}break;
+	#endif
+	#ifdef AGMV_HAS_NEON
+		case AGMV_SIMD_NEON:{
+			kernels = &neon_kernels;
+		}break;
+	#endif
+		default:{
+			kernels = &scalar_kernels;
+		}break;
+	}
+
+	simd_level = simd;
+}
+
+/* PICKS THE WIDEST INSTRUCTION SET THE CPU SUPPORTS */
+static void AGMV_InitKernels(){
+	if(AGMV_IsSIMDSupported(AGMV_SIMD_AVX2)){
+		AGMV_SelectKernels(AGMV_SIMD_AVX2);
+	}
+	else if(AGMV_IsSIMDSupported(AGMV_SIMD_SSE2)){
+		AGMV_SelectKernels(AGMV_SIMD_SSE2);
+	}
+	else if(AGMV_IsSIMDSupported(AGMV_SIMD_NEON)){
+		AGMV_SelectKernels(AGMV_SIMD_NEON);
+	}
+	else{
+		AGMV_SelectKernels(AGMV_SIMD_NONE);
+	}
+}
+
+#if defined(_WIN32)
+static BOOL CALLBACK AGMV_InitKernelsOnce(PINIT_ONCE once, PVOID param, PVOID* context){
+	AGMV_InitKernels();
+	return TRUE;
+}
+#endif
+
+/* RENDERS ON ANY NUMBER OF THREADS MAY ASK FOR THE TABLE FIRST, SO IT IS RESOLVED EXACTLY ONCE */
+static void AGMV_ResolveKernels(){
+	#if defined(_WIN32)
+		InitOnceExecuteOnce(&kernels_once,AGMV_InitKernelsOnce,NULL,NULL);
+	#else
+		pthread_once(&kernels_once,AGMV_InitKernels);
+	#endif
+}
+
+/* NOT SYNCHRONIZED WITH RENDERING. CALL IT BEFORE ANY STREAM STARTS DECODING, NEVER WHILE ONE IS MID-RENDER ON ANOTHER THREAD */
+void AGMV_SetSIMD(AGMV_SIMD simd){
+	if(!AGMV_IsSIMDSupported(simd)){
+		return;
+	}
+
+	AGMV_ResolveKernels();
+	AGMV_SelectKernels(simd);
+}
+
+const AGMV_BLOCK_KERNELS* AGMV_GetBlockKernels(){
+	AGMV_ResolveKernels();
+	return kernels;
+}
+
+AGMV_SIMD AGMV_GetSIMD(){
+	AGMV_ResolveKernels();
+	return simd_level;
+}
@@ -0,0 +1,474 @@
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmv_thread.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+#include <stdlib.h>
+#include <agmv_thread.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+/*-------THREADING PRIMITIVES------*/
+
+typedef struct AGMV_THREAD_START{
+	AGMV_THREAD_FUNC func;
+	void* data;
+}AGMV_THREAD_START;
+
+#if defined(_WIN32)
+static DWORD WINAPI AGMV_ThreadEntry(LPVOID param){
+#else
+static void* AGMV_ThreadEntry(void* param){
+#endif
+	AGMV_THREAD_START start = *(AGMV_THREAD_START*)param;
+	free(param);
+	
+	start.func(start.data);
+	
+	return 0;
+}
+
+AGMV_THREAD AGMV_CreateThread(AGMV_THREAD_FUNC func, void* data){
+	AGMV_THREAD_START* start = (AGMV_THREAD_START*)malloc(sizeof(AGMV_THREAD_START));
+	
+	start->func = func;
+	start->data = data;
+	
+	#if defined(_WIN32)
+	{
+		HANDLE thread = CreateThread(NULL,0,AGMV_ThreadEntry,start,0,NULL);
+		
+		if(thread == NULL){
+			free(start);
+		}
+		
+		return (AGMV_THREAD)thread;
+	}
+	#else
+	{
+		pthread_t* thread = (pthread_t*)malloc(sizeof(pthread_t));
+		
+		if(pthread_create(thread,NULL,AGMV_ThreadEntry,start) != 0){
+			free(thread);
+			free(start);
+			return NULL;
+		}
+		
+		return (AGMV_THREAD)thread;
+	}
+	#endif
+}
+
+void AGMV_JoinThread(AGMV_THREAD thread){
+	if(thread != NULL){
+	#if defined(_WIN32)
+		WaitForSingleObject((HANDLE)thread,INFINITE);
+		CloseHandle((HANDLE)thread);
+	#else
+		pthread_join(*(pthread_t*)thread,NULL);
+		free(thread);
+	#endif
+	}
+}
+
+AGMV_MUTEX AGMV_CreateMutex(){
+	#if defined(_WIN32)
+		CRITICAL_SECTION* mutex = (CRITICAL_SECTION*)malloc(sizeof(CRITICAL_SECTION));
+		InitializeCriticalSection(mutex);
+	#else
+		pthread_mutex_t* mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+		pthread_mutex_init(mutex,NULL);
+	#endif
+	
+	return (AGMV_MUTEX)mutex;
+}
+
+void AGMV_DestroyMutex(AGMV_MUTEX mutex){
+	if(mutex != NULL){
+	#if defined(_WIN32)
+		DeleteCriticalSection((CRITICAL_SECTION*)mutex);
+	#else
+		pthread_mutex_destroy((pthread_mutex_t*)mutex);
+	#endif
+		free(mutex);
+	}
+}
+
+void AGMV_LockMutex(AGMV_MUTEX mutex){
+	#if defined(_WIN32)
+		EnterCriticalSection((CRITICAL_SECTION*)mutex);
+	#else
+		pthread_mutex_lock((pthread_mutex_t*)mutex);
+	#endif
+}
+
+void AGMV_UnlockMutex(AGMV_MUTEX mutex){
+	#if defined(_WIN32)
+		LeaveCriticalSection((CRITICAL_SECTION*)mutex);
+	#else
+		pthread_mutex_unlock((pthread_mutex_t*)mutex);
+	#endif
+}
+
+AGMV_COND AGMV_CreateCond(){
+	#if defined(_WIN32)
+		CONDITION_VARIABLE* cond = (CONDITION_VARIABLE*)malloc(sizeof(CONDITION_VARIABLE));
+		InitializeConditionVariable(cond);
+	#else
+		pthread_cond_t* cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
+		pthread_cond_init(cond,NULL);
+	#endif
+	
+	return (AGMV_COND)cond;
+}
+
+void AGMV_DestroyCond(AGMV_COND cond){
+	if(cond != NULL){
+	#if !defined(_WIN32)
+		pthread_cond_destroy((pthread_cond_t*)cond);
+	#endif
+		free(cond);
+	}
+}
+
+void AGMV_WaitCond(AGMV_COND cond, AGMV_MUTEX mutex){
+	#if defined(_WIN32)
+		SleepConditionVariableCS((CONDITION_VARIABLE*)cond,(CRITICAL_SECTION*)mutex,INFINITE);
+	#else
+		pthread_cond_wait((pthread_cond_t*)cond,(pthread_mutex_t*)mutex);
+	#endif
+}
+
+void AGMV_SignalCond(AGMV_COND cond){
+	#if defined(_WIN32)
+		WakeConditionVariable((CONDITION_VARIABLE*)cond);
+	#else
+		pthread_cond_signal((pthread_cond_t*)cond);
+	#endif
+}
+
+void AGMV_BroadcastCond(AGMV_COND cond){
+	#if defined(_WIN32)
+		WakeAllConditionVariable((CONDITION_VARIABLE*)cond);
+	#else
+		pthread_cond_broadcast((pthread_cond_t*)cond);
+	#endif
+}
+
+u32 AGMV_GetNumberOfCores(){
+	#if defined(_WIN32)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+	#elif defined(_SC_NPROCESSORS_ONLN)
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		return cores > 0 ? (u32)cores : 1;
+	#else
+		return 1;
+	#endif
+}
+
+u32 AGMV_AtomicLoad(volatile u32* value){
+	#if defined(_MSC_VER)
+		u32 num = *value;
+		_ReadWriteBarrier();
+		MemoryBarrier();
+		return num;
+	#else
+		return __atomic_load_n(value,__ATOMIC_ACQUIRE);
+	#endif
+}
+
+void AGMV_AtomicStore(volatile u32* value, u32 num){
+	#if defined(_MSC_VER)
+		MemoryBarrier();
+		_ReadWriteBarrier();
+		*value = num;
+	#else
+		__atomic_store_n(value,num,__ATOMIC_RELEASE);
+	#endif
+}
+
+/* FULL BARRIER, ORDERS A STORE BEFORE A LATER LOAD, WHICH ACQUIRE AND RELEASE ALONE DO NOT */
+void AGMV_AtomicFence(){
+	#if defined(_MSC_VER)
+		MemoryBarrier();
+	#else
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	#endif
+}
+
+void AGMV_SleepMS(u32 ms){
+	#if defined(_WIN32)
+		Sleep(ms);
+	#else
+		usleep(ms*1000);
+	#endif
+}
+
+/*-------THREAD POOL------*/
+
+/* WORKERS SLEEP UNTIL A BATCH IS POSTED, THEN PULL TASK INDICES UNTIL THE BATCH IS EXHAUSTED */
+static void AGMV_PoolWorker(void* data){
+	AGMV_THREAD_POOL* pool = (AGMV_THREAD_POOL*)data;
+	u32 index;
+	
+	AGMV_LockMutex(pool->lock);
+	
+	while(TRUE){
+		while(pool->quit != TRUE && pool->next >= pool->count){
+			AGMV_WaitCond(pool->wake,pool->lock);
+		}
+		
+		if(pool->quit == TRUE){
+			break;
+		}
+		
+		index = pool->next++;
+		
+		AGMV_UnlockMutex(pool->lock);
+		pool->task(pool->data,index);
+		AGMV_LockMutex(pool->lock);
+		
+		if(++pool->finished == pool->count){
+			AGMV_SignalCond(pool->done);
+		}
+	}
+	
+	AGMV_UnlockMutex(pool->lock);
+}
+
+AGMV_THREAD_POOL* AGMV_CreateThreadPool(u32 num_of_threads){
+	AGMV_THREAD_POOL* pool = (AGMV_THREAD_POOL*)malloc(sizeof(AGMV_THREAD_POOL));
+	u32 i;
+	
+	if(num_of_threads < 1){
+		num_of_threads = 1;
+	}
+	
+	pool->num_of_threads = num_of_threads;
+	pool->lock = AGMV_CreateMutex();
+	pool->wake = AGMV_CreateCond();
+	pool->done = AGMV_CreateCond();
+	pool->task = NULL;
+	pool->data = NULL;
+	pool->count = 0;
+	pool->next = 0;
+	pool->finished = 0;
+	pool->quit = FALSE;
+	pool->threads = NULL;
+	
+	/* THE THREAD CALLING AGMV_ThreadPoolRun ALSO WORKS, SO SPAWN ONE FEWER */
+	if(num_of_threads > 1){
+		pool->threads = (AGMV_THREAD*)malloc(sizeof(AGMV_THREAD)*(num_of_threads-1));
+		
+		for(i = 0; i < num_of_threads-1; i++){
+			pool->threads[i] = AGMV_CreateThread(AGMV_PoolWorker,pool);
+		}
+	}
+	
+	return pool;
+}
+
+void AGMV_ThreadPoolRun(AGMV_THREAD_POOL* pool, AGMV_TASK task, void* data, u32 count){
+	u32 index;
+	
+	if(pool == NULL || pool->num_of_threads <= 1 || count <= 1){
+		for(index = 0; index < count; index++){
+			task(data,index);
+		}
+		return;
+	}
+	
+	AGMV_LockMutex(pool->lock);
+	
+	pool->task = task;
+	pool->data = data;
+	pool->count = count;
+	pool->next = 0;
+	pool->finished = 0;
+	
+	AGMV_BroadcastCond(pool->wake);
+	
+	while(pool->next < pool->count){
+		index = pool->next++;
+		
+		AGMV_UnlockMutex(pool->lock);
+		task(data,index);
+		AGMV_LockMutex(pool->lock);
+		
+		pool->finished++;
+	}
+	
+	while(pool->finished < pool->count){
+		AGMV_WaitCond(pool->done,pool->lock);
+	}
+	
+	pool->count = 0;
+	pool->next = 0;
+	
+	AGMV_UnlockMutex(pool->lock);
+}
+
+void AGMV_DestroyThreadPool(AGMV_THREAD_POOL* pool){
+	u32 i;
+	
+	if(pool != NULL){
+		AGMV_LockMutex(pool->lock);
+		pool->quit = TRUE;
+		AGMV_BroadcastCond(pool->wake);
+		AGMV_UnlockMutex(pool->lock);
+		
+		if(pool->threads != NULL){
+			for(i = 0; i < pool->num_of_threads-1; i++){
+				AGMV_JoinThread(pool->threads[i]);
+			}
+			free(pool->threads);
+		}
+		
+		AGMV_DestroyCond(pool->done);
+		AGMV_DestroyCond(pool->wake);
+		AGMV_DestroyMutex(pool->lock);
+		free(pool);
+	}
+}
+
+/*-------SINGLE PRODUCER SINGLE CONSUMER RING------*/
+
+AGMV_RING* AGMV_CreateRing(u32 capacity){
+	AGMV_RING* ring = (AGMV_RING*)malloc(sizeof(AGMV_RING));
+	
+	if(capacity < 1){
+		capacity = 1;
+	}
+	
+	ring->slots = (void**)calloc(capacity,sizeof(void*));
+	ring->capacity = capacity;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->closed = FALSE;
+	ring->waiters = 0;
+	ring->lock = AGMV_CreateMutex();
+	ring->cond = AGMV_CreateCond();
+	
+	return ring;
+}
+
+void AGMV_DestroyRing(AGMV_RING* ring){
+	if(ring != NULL){
+		AGMV_DestroyCond(ring->cond);
+		AGMV_DestroyMutex(ring->lock);
+		free(ring->slots);
+		free(ring);
+	}
+}
+
+static void AGMV_WakeRing(AGMV_RING* ring){
+	AGMV_LockMutex(ring->lock);
+	AGMV_BroadcastCond(ring->cond);
+	AGMV_UnlockMutex(ring->lock);
+}
+
+/* CALLED AFTER PUBLISHING A NEW HEAD OR TAIL. THE FENCE PAIRS WITH THE ONE A SLEEPER ISSUES AFTER REGISTERING, SO EITHER THE SLEEPER
+   SEES THE NEW COUNTER BEFORE WAITING OR THIS SEES THE SLEEPER. WHEN NOBODY SLEEPS THE MUTEX IS NEVER TOUCHED */
+static void AGMV_SignalRing(AGMV_RING* ring){
+	AGMV_AtomicFence();
+	
+	if(AGMV_AtomicLoad(&ring->waiters) != 0){
+		AGMV_WakeRing(ring);
+	}
+}
+
+static void AGMV_BeginRingWait(AGMV_RING* ring){
+	AGMV_LockMutex(ring->lock);
+	AGMV_AtomicStore(&ring->waiters,ring->waiters+1);
+	AGMV_AtomicFence();
+}
+
+static void AGMV_EndRingWait(AGMV_RING* ring){
+	AGMV_AtomicStore(&ring->waiters,ring->waiters-1);
+	AGMV_UnlockMutex(ring->lock);
+}
+
+/* RETURNS THE NEXT FREE SLOT, OR NULL IF THE RING IS FULL(AND WAIT IS FALSE) OR HAS BEEN CLOSED */
+void* AGMV_RingBeginWrite(AGMV_RING* ring, Bool wait){
+	u32 head = ring->head;
+	
+	if(head - AGMV_AtomicLoad(&ring->tail) >= ring->capacity){
+		if(wait != TRUE){
+			return NULL;
+		}
+		
+		AGMV_BeginRingWait(ring);
+		while(AGMV_AtomicLoad(&ring->closed) != TRUE && head - AGMV_AtomicLoad(&ring->tail) >= ring->capacity){
+			AGMV_WaitCond(ring->cond,ring->lock);
+		}
+		AGMV_EndRingWait(ring);
+	}
+	
+	if(AGMV_AtomicLoad(&ring->closed) == TRUE){
+		return NULL;
+	}
+	
+	return ring->slots[head % ring->capacity];
+}
+
+void AGMV_RingEndWrite(AGMV_RING* ring){
+	AGMV_AtomicStore(&ring->head,ring->head+1);
+	AGMV_SignalRing(ring);
+}
+
+/* RETURNS THE OLDEST PUBLISHED SLOT, OR NULL IF THE RING IS EMPTY(AND WAIT IS FALSE) OR IS CLOSED AND FULLY DRAINED */
+void* AGMV_RingBeginRead(AGMV_RING* ring, Bool wait){
+	u32 tail = ring->tail;
+	
+	if(AGMV_AtomicLoad(&ring->head) == tail){
+		if(wait != TRUE){
+			return NULL;
+		}
+		
+		AGMV_BeginRingWait(ring);
+		while(AGMV_AtomicLoad(&ring->closed) != TRUE && AGMV_AtomicLoad(&ring->head) == tail){
+			AGMV_WaitCond(ring->cond,ring->lock);
+		}
+		AGMV_EndRingWait(ring);
+		
+		if(AGMV_AtomicLoad(&ring->head) == tail){
+			return NULL;
+		}
+	}
+	
+	return ring->slots[tail % ring->capacity];
+}
+
+void AGMV_RingEndRead(AGMV_RING* ring){
+	AGMV_AtomicStore(&ring->tail,ring->tail+1);
+	AGMV_SignalRing(ring);
+}
+
+u32 AGMV_RingCount(AGMV_RING* ring){
+	return AGMV_AtomicLoad(&ring->head) - AGMV_AtomicLoad(&ring->tail);
+}
+
+/* CLOSING TELLS THE CONSUMER NO MORE SLOTS ARE COMING AND RELEASES A PRODUCER BLOCKED ON A FULL RING */
+void AGMV_CloseRing(AGMV_RING* ring){
+	AGMV_AtomicStore(&ring->closed,TRUE);
+	AGMV_WakeRing(ring);
+}
+
+Bool AGMV_IsRingDrained(AGMV_RING* ring){
+	return AGMV_AtomicLoad(&ring->closed) == TRUE && AGMV_RingCount(ring) == 0;
+}
@@ -12,8 +12,10 @@
 *
 ********************************************/
 #include <stdlib.h>
+#include <string.h>
 #include <agmv_utils.h>
 #include <agmv_decode.h>
+#include <agmv_thread.h>
 
 /*-------FILE READING UTILITY FUNCTIONS------*/
 
@@ -29,33 +31,29 @@ Bool AGMV_EOF(FILE* file){
 	else return FALSE;
 }
 
-u32 matchlength = 0,
-    matchpos = 0,
-    bitbuf = 0,
-    bitsin = 0,
-    masks[17] = {0,1,3,7,15,31,63,127,255,511,1023,2047,4095,8191,16383,32767,65535};
+static const u32 masks[17] = {0,1,3,7,15,31,63,127,255,511,1023,2047,4095,8191,16383,32767,65535};
 
-u32 AGMV_ReadBits(FILE* file, u32 num_of_bits){
+u32 AGMV_ReadBits(FILE* file, AGMV_BITSTREAM* stream, u32 num_of_bits){
 	
 	register u32 i;
 
-	i = bitbuf >> (8 - bitsin);
+	i = stream->bitbuf >> (8 - stream->bitsin);
 
-	while (num_of_bits > bitsin)
+	while (num_of_bits > stream->bitsin)
 	{
-		bitbuf = AGMV_ReadByte(file);
-		i |= (bitbuf << bitsin);
-		bitsin += 8;
+		stream->bitbuf = AGMV_ReadByte(file);
+		i |= (stream->bitbuf << stream->bitsin);
+		stream->bitsin += 8;
 	}
 
-	bitsin -= num_of_bits;
+	stream->bitsin -= num_of_bits;
 
 	return (i & masks[num_of_bits]);
 }
 
-void AGMV_FlushReadBits() {
-    bitbuf = 0;
-    bitsin = 0;
+void AGMV_FlushReadBits(AGMV_BITSTREAM* stream) {
+    stream->bitbuf = 0;
+    stream->bitsin = 0;
 }
 
 u8 AGMV_ReadByte(FILE* file){
@@ -83,31 +81,31 @@ void AGMV_ReadFourCC(FILE* file, char fourcc[4]){
 	fourcc[3] = AGMV_ReadByte(file);
 }
 
-void AGMV_WriteBits(FILE* file, u32 num, u16 num_of_bits){
-	bitbuf |= (num << bitsin);
+void AGMV_WriteBits(FILE* file, AGMV_BITSTREAM* stream, u32 num, u16 num_of_bits){
+	stream->bitbuf |= (num << stream->bitsin);
 
-	bitsin += num_of_bits;
+	stream->bitsin += num_of_bits;
 
-	if (bitsin > 16) 
+	if (stream->bitsin > 16) 
 	{
-		AGMV_WriteByte(file,bitbuf & 0xFF);
-		bitbuf = num >> (8 - (bitsin - num_of_bits));
-		bitsin -= 8;
+		AGMV_WriteByte(file,stream->bitbuf & 0xFF);
+		stream->bitbuf = num >> (8 - (stream->bitsin - num_of_bits));
+		stream->bitsin -= 8;
 	}
 
-	while (bitsin >= 8)
+	while (stream->bitsin >= 8)
 	{
-		AGMV_WriteByte(file,bitbuf & 0xFF);
-		bitbuf >>= 8;
-		bitsin -= 8;
+		AGMV_WriteByte(file,stream->bitbuf & 0xFF);
+		stream->bitbuf >>= 8;
+		stream->bitsin -= 8;
 	}
 }
 
-void AGMV_FlushWriteBits(FILE* file){
-	if (bitsin > 0) {
-        AGMV_WriteByte(file, bitbuf & 0xFF);
-        bitbuf = 0;
-        bitsin = 0;
+void AGMV_FlushWriteBits(FILE* file, AGMV_BITSTREAM* stream){
+	if (stream->bitsin > 0) {
+        AGMV_WriteByte(file, stream->bitbuf & 0xFF);
+        stream->bitbuf = 0;
+        stream->bitsin = 0;
     }
 }
 
@@ -130,67 +128,120 @@ void AGMV_WriteFourCC(FILE* file, char f, char o, char u, char r){
 	AGMV_WriteByte(file,r);
 }
 
-Bool AGMV_IsCorrectFourCC(char fourcc[4], char f, char o, char u, char r){
-	if(f != fourcc[0] || o != fourcc[1] || u != fourcc[2] || r != fourcc[3]){
-		return FALSE;
+/* MEMORY COUNTERPARTS OF THE WRITE FUNCTIONS ABOVE. THEY APPEND TO STREAM->DATA, DOUBLING IT WHEN FULL, SO AN ENCODER CAN
+   BUILD A WHOLE CHUNK BEFORE HANDING IT TO THE FILE IN ONE WRITE */
+void AGMV_ReserveBitstream(AGMV_BITSTREAM* stream, u32 len){
+	if(stream->pos + len > stream->len || stream->data == NULL){
+		u32 size = stream->len > 0 ? stream->len : 64;
+		
+		while(size < stream->pos + len){
+			size *= 2;
+		}
+		
+		stream->data = (u8*)realloc(stream->data,sizeof(u8)*size);
+		stream->len = size;
 	}
-	else return TRUE;
 }
 
-void AGMV_FindNextFrameChunk(FILE* file){
-	u32 pos;
-	Bool isFrame;
-	char fourcc[4];
+void AGMV_PutByte(AGMV_BITSTREAM* stream, u8 byte){
+	if(stream->pos >= stream->len){
+		AGMV_ReserveBitstream(stream,1);
+	}
+	
+	stream->data[stream->pos++] = byte;
+}
 
-	AGMV_ReadFourCC(file,fourcc);
-	isFrame = AGMV_IsCorrectFourCC(fourcc,'A','G','F','C');
+void AGMV_PutShort(AGMV_BITSTREAM* stream, u16 word){
+	AGMV_ReserveBitstream(stream,2);
+	memcpy(stream->data + stream->pos,&word,2);
+	stream->pos += 2;
+}
 
-	if(isFrame){
-		pos = ftell(file);
-		fseek(file,pos-4,SEEK_SET);
-		return;
-	}
+void AGMV_PutLong(AGMV_BITSTREAM* stream, u32 dword){
+	AGMV_ReserveBitstream(stream,4);
+	memcpy(stream->data + stream->pos,&dword,4);
+	stream->pos += 4;
+}
 
-	while(!isFrame && !AGMV_EOF(file)){
-		AGMV_ReadFourCC(file,fourcc);
-		isFrame = AGMV_IsCorrectFourCC(fourcc,'A','G','F','C');
-		
-		if(!isFrame){
-			pos = ftell(file);
-			fseek(file,pos-3,SEEK_SET);
-		}
+void AGMV_PutFourCC(AGMV_BITSTREAM* stream, char f, char o, char u, char r){
+	AGMV_PutByte(stream,f);
+	AGMV_PutByte(stream,o);
+	AGMV_PutByte(stream,u);
+	AGMV_PutByte(stream,r);
+}
+
+void AGMV_PutBits(AGMV_BITSTREAM* stream, u32 num, u16 num_of_bits){
+	stream->bitbuf |= (num << stream->bitsin);
+
+	stream->bitsin += num_of_bits;
+
+	if (stream->bitsin > 16) 
+	{
+		AGMV_PutByte(stream,stream->bitbuf & 0xFF);
+		stream->bitbuf = num >> (8 - (stream->bitsin - num_of_bits));
+		stream->bitsin -= 8;
 	}
 
-	pos = ftell(file);
-	fseek(file,pos-4,SEEK_SET);
+	while (stream->bitsin >= 8)
+	{
+		AGMV_PutByte(stream,stream->bitbuf & 0xFF);
+		stream->bitbuf >>= 8;
+		stream->bitsin -= 8;
+	}
 }
 
-void AGMV_FindNextAudioChunk(FILE* file){
-	u32 pos;
-	Bool isAudio;
-	char fourcc[4];
+Bool AGMV_IsCorrectFourCC(char fourcc[4], char f, char o, char u, char r){
+	if(f != fourcc[0] || o != fourcc[1] || u != fourcc[2] || r != fourcc[3]){
+		return FALSE;
+	}
+	else return TRUE;
+}
 
-	AGMV_ReadFourCC(file,fourcc);
-	isAudio = AGMV_IsCorrectFourCC(fourcc,'A','G','A','C');
+#define AGMV_SCAN_SIZE 4096
 
-	if(isAudio){
-		pos = ftell(file);
-		fseek(file,pos-4,SEEK_SET);
-		return;
+Bool AGMV_FindNextChunk(FILE* file, char f, char o, char u, char r){
+	u8 buf[AGMV_SCAN_SIZE + 3];
+	u32 pos = ftell(file), keep = 0, n, skip, i;
+	
+	/* A CHUNK NORMALLY STARTS RIGHT HERE, OR RIGHT AFTER THE 8 BYTES OF 0xFF PADDING THAT FOLLOW EVERY FRAME */
+	
+	n = fread(buf,1,12,file);
+	
+	for(skip = 0; skip < 8 && skip < n && buf[skip] == 0xFF; skip++);
+	
+	if(skip + 4 <= n && buf[skip] == (u8)f && buf[skip+1] == (u8)o && buf[skip+2] == (u8)u && buf[skip+3] == (u8)r){
+		fseek(file,pos+skip,SEEK_SET);
+		return TRUE;
 	}
-
-	while(!isAudio && !AGMV_EOF(file)){
-		AGMV_ReadFourCC(file,fourcc);
-		isAudio = AGMV_IsCorrectFourCC(fourcc,'A','G','A','C');
+	
+	/* OTHERWISE RESYNC BY SCANNING THE FILE A BLOCK AT A TIME */
+	
+	fseek(file,pos,SEEK_SET);
+	
+	while((n = fread(buf + keep,1,AGMV_SCAN_SIZE,file)) > 0){
+		n += keep;
 		
-		if(!isAudio){
-			pos = ftell(file);
-			fseek(file,pos-3,SEEK_SET);
+		for(i = 0; i + 4 <= n; i++){
+			if(buf[i] == (u8)f && buf[i+1] == (u8)o && buf[i+2] == (u8)u && buf[i+3] == (u8)r){
+				fseek(file,pos+i,SEEK_SET);
+				return TRUE;
+			}
 		}
+		
+		keep = n < 3 ? n : 3;
+		memmove(buf,buf + n - keep,keep);
+		pos += n - keep;
 	}
+	
+	return FALSE;
+}
+
+void AGMV_FindNextFrameChunk(FILE* file){
+	AGMV_FindNextChunk(file,'A','G','F','C');
+}
 
-	pos = ftell(file);
-	fseek(file,pos-4,SEEK_SET);
+void AGMV_FindNextAudioChunk(FILE* file){
+	AGMV_FindNextChunk(file,'A','G','A','C');
 }
 
 void AGMV_SkipFrameChunk(FILE* file){
@@ -220,11 +271,28 @@ void AGMV_SkipAudioChunk(FILE* file){
 void AGMV_ParseAGMV(FILE* file, AGMV* agmv){
 	u32 n = AGMV_GetNumberOfFrames(agmv);
 	
+	/* WITH A SEEK INDEX THE FRAME OFFSETS ARE ALREADY KNOWN, ONLY THE AUDIO HAS TO BE READ */
+	
+	if(agmv->header.index_offset != 0 && AGMV_LoadIndex(file,agmv) == NO_ERR){
+		AGMV_INDEX_ENTRY* entries = agmv->index->entries;
+		
+		int i;
+		for(i = 0; i < n && i < agmv->index->len; i++){
+			if(AGMV_GetTotalAudioDuration(agmv) != 0 && entries[i].audio_offset != 0){
+				fseek(file,entries[i].audio_offset,SEEK_SET);
+				AGMV_DecodeAudioChunk(file,agmv);
+			}
+		}
+		
+		agmv->frame_count = 0;
+		return;
+	}
+	
 	if(AGMV_GetTotalAudioDuration(agmv) != 0){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 			AGMV_FindNextAudioChunk(file);
 			AGMV_DecodeAudioChunk(file,agmv);
@@ -234,7 +302,7 @@ void AGMV_ParseAGMV(FILE* file, AGMV* agmv){
 		int i;
 		for(i = 0; i < n; i++){
 			AGMV_FindNextFrameChunk(file);
-			agmv->offset_table[agmv->frame_count++] = ftell(file);
+			AGMV_RecordFrameOffset(agmv,agmv->frame_count++,ftell(file));
 			AGMV_SkipFrameChunk(file);
 		}
 	}
@@ -242,6 +310,107 @@ void AGMV_ParseAGMV(FILE* file, AGMV* agmv){
 	agmv->frame_count = 0;
 }
 
+u32 AGMV_GetHeaderSize(AGMV* agmv){
+	if(agmv->header.version == 1 || agmv->header.version == 3){
+		return 1574;
+	}
+	else{
+		return 806;
+	}
+}
+
+AGMV_INDEX_ENTRY* AGMV_ReserveIndexEntry(AGMV* agmv, u32 n){
+	AGMV_INDEX* index = agmv->index;
+	
+	if(index == NULL){
+		index = (AGMV_INDEX*)malloc(sizeof(AGMV_INDEX));
+		index->entries = NULL;
+		index->len = 0;
+		index->size = 0;
+		index->loaded = FALSE;
+		agmv->index = index;
+	}
+	
+	if(n >= index->size){
+		u32 size = index->size ? index->size : 64;
+		
+		while(n >= size){
+			size *= 2;
+		}
+		
+		index->entries = (AGMV_INDEX_ENTRY*)realloc(index->entries,sizeof(AGMV_INDEX_ENTRY)*size);
+		memset(index->entries + index->size,0,sizeof(AGMV_INDEX_ENTRY)*(size - index->size));
+		index->size = size;
+	}
+	
+	if(n >= index->len){
+		index->len = n + 1;
+	}
+	
+	return &index->entries[n];
+}
+
+void AGMV_SetIndexFrameOffset(AGMV* agmv, u32 n, u32 frame_offset, u8 flags){
+	AGMV_INDEX_ENTRY* entry = AGMV_ReserveIndexEntry(agmv,n);
+	entry->frame_offset = frame_offset;
+	entry->flags = flags;
+}
+
+/* RECORDING A CHUNK THE LOADED INDEX ALREADY HAS KEEPS THE FLAGS THE ENCODER WROTE FOR IT */
+void AGMV_RecordFrameOffset(AGMV* agmv, u32 n, u32 frame_offset){
+	u8 flags = n % 4 == 0 ? AGMV_INDEX_IFRAME : 0;
+	
+	if(agmv->index != NULL && n < agmv->index->len && agmv->index->entries[n].frame_offset == frame_offset){
+		flags = agmv->index->entries[n].flags;
+	}
+	
+	AGMV_SetIndexFrameOffset(agmv,n,frame_offset,flags);
+}
+
+void AGMV_SetIndexAudioOffset(AGMV* agmv, u32 n, u32 audio_offset){
+	AGMV_INDEX_ENTRY* entry = AGMV_ReserveIndexEntry(agmv,n);
+	entry->audio_offset = audio_offset;
+}
+
+int AGMV_LoadIndex(FILE* file, AGMV* agmv){
+	char fourcc[4];
+	u32 pos = ftell(file), file_size, count, i;
+	
+	fseek(file,0,SEEK_END);
+	file_size = ftell(file);
+	
+	if(agmv->header.index_offset == 0 || agmv->header.index_offset + 8 > file_size){
+		fseek(file,pos,SEEK_SET);
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	fseek(file,agmv->header.index_offset,SEEK_SET);
+	
+	AGMV_ReadFourCC(file,fourcc);
+	count = AGMV_ReadLong(file);
+	
+	if(!AGMV_IsCorrectFourCC(fourcc,'A','G','I','C') || count == 0 || count > (file_size - agmv->header.index_offset - 8) / AGMV_INDEX_ENTRY_SIZE){
+		fseek(file,pos,SEEK_SET);
+		return INVALID_HEADER_FORMATTING_ERR;
+	}
+	
+	AGMV_ReserveIndexEntry(agmv,count-1);
+	agmv->index->len = count;
+	
+	for(i = 0; i < count; i++){
+		AGMV_INDEX_ENTRY* entry = &agmv->index->entries[i];
+		entry->frame_offset = AGMV_ReadLong(file);
+		entry->audio_offset = AGMV_ReadLong(file);
+		entry->flags = AGMV_ReadByte(file);
+	}
+	
+	agmv->index->loaded = TRUE;
+	
+	fseek(file,pos,SEEK_SET);
+	
+	return NO_ERR;
+}
+
 /*------PRIMARY FUNCTIONS TO INITIALIZE AGMV ATTRIBUTES----------*/
 
 void AGMV_SetWidth(AGMV* agmv, u32 width){
@@ -310,6 +479,17 @@ void AGMV_SetCompression(AGMV* agmv, AGMV_COMPRESSION compression){
 	agmv->compression = compression;
 }
 
+/* CANDIDATES THE MATCH FINDER VISITS PER POSITION. 0 SEARCHES THE WHOLE WINDOW AND REPRODUCES THE OLD EXHAUSTIVE SEARCH BYTE FOR
+   BYTE, BUT IS QUADRATIC ON VERY REPETITIVE BITSTREAMS */
+void AGMV_SetMatchDepth(AGMV* agmv, u32 depth){
+	agmv->match_depth = depth;
+}
+
+/* ONLY AFFECTS LZ77 COMPRESSION. OPTIMAL IS NEVER LARGER THAN GREEDY AND BOTH DECODE THE SAME WAY */
+void AGMV_SetLZ77Parse(AGMV* agmv, AGMV_LZ_PARSE parse){
+	agmv->lz77_parse = parse;
+}
+
 void AGMV_SetAudioState(AGMV* agmv, Bool audio){
 	agmv->enable_audio = audio;
 }
@@ -329,6 +509,98 @@ void AGMV_SetBitsPerSample(AGMV* agmv, u16 bits_per_sample){
 	agmv->header.bits_per_sample = bits_per_sample;
 }
 
+static void AGMV_SetThreadPool(AGMV* agmv, u32 num_of_threads){
+	if(agmv->pool != NULL){
+		AGMV_DestroyThreadPool(agmv->pool);
+		agmv->pool = NULL;
+	}
+	
+	if(num_of_threads > 1){
+		agmv->pool = AGMV_CreateThreadPool(num_of_threads);
+	}
+}
+
+void AGMV_SetDecodeThreads(AGMV* agmv, u32 num_of_threads){
+	if(num_of_threads == 0){
+		num_of_threads = AGMV_GetNumberOfCores();
+	}
+	
+	AGMV_SetThreadPool(agmv,num_of_threads);
+}
+
+static void AGMV_InitBitstream(AGMV_BITSTREAM* bitstream, u32 len){
+	bitstream->data = len > 0 ? (u8*)malloc(sizeof(u8)*len) : NULL;
+	bitstream->len = len;
+	bitstream->pos = 0;
+	bitstream->bitbuf = 0;
+	bitstream->bitsin = 0;
+}
+
+static void AGMV_DestroyEncoder(AGMV_ENCODER* encoder){
+	u32 i;
+	
+	for(i = 0; i < encoder->capacity; i++){
+		free(encoder->slots[i].img_data);
+		free(encoder->slots[i].img_entry);
+		free(encoder->slots[i].bitstream.data);
+		free(encoder->slots[i].chunk.data);
+		free(encoder->slots[i].audio.data);
+	}
+	
+	free(encoder->slots);
+	free(encoder);
+}
+
+/* AGMV_EncodeFrame QUEUES ONE FRAME PER THREAD AND ENCODES THEM TOGETHER WHEN THE QUEUE FILLS. QUEUED FRAMES ONLY REACH THE FILE
+   THEN OR ON AGMV_FlushEncoder, SO FLUSH BEFORE SEEKING IN THE FILE, CHANGING THE PALETTES OR CHANGING THE THREAD COUNT.
+   AGMV_EncodeAGMV AND AGMV_EncodeFullAGMV USE ONE THREAD PER CORE ONLY IF THE HANDLE HAS NO THREADS SET YET */
+void AGMV_SetEncodeThreads(AGMV* agmv, u32 num_of_threads){
+	u32 i, size = AGMV_GetWidth(agmv)*AGMV_GetHeight(agmv);
+	AGMV_ENCODER* encoder;
+	
+	if(num_of_threads == 0){
+		num_of_threads = AGMV_GetNumberOfCores();
+	}
+	
+	AGMV_SetThreadPool(agmv,num_of_threads);
+	
+	if(agmv->encoder != NULL){
+		AGMV_DestroyEncoder(agmv->encoder);
+		agmv->encoder = NULL;
+	}
+	
+	if(num_of_threads <= 1){
+		return;
+	}
+	
+	encoder = (AGMV_ENCODER*)malloc(sizeof(AGMV_ENCODER));
+	encoder->slots = (AGMV_ENCODE_SLOT*)malloc(sizeof(AGMV_ENCODE_SLOT)*num_of_threads);
+	encoder->capacity = num_of_threads;
+	encoder->count = 0;
+	
+	for(i = 0; i < num_of_threads; i++){
+		encoder->slots[i].frame_num = 0;
+		encoder->slots[i].img_data = (u32*)malloc(sizeof(u32)*size);
+		encoder->slots[i].img_entry = (AGMV_ENTRY*)malloc(sizeof(AGMV_ENTRY)*size);
+		encoder->slots[i].audio_offset = 0;
+		AGMV_InitBitstream(&encoder->slots[i].bitstream,size*2);
+		AGMV_InitBitstream(&encoder->slots[i].chunk,0);
+		AGMV_InitBitstream(&encoder->slots[i].audio,0);
+	}
+	
+	agmv->encoder = encoder;
+}
+
+/* WHILE ENABLED EVERY RENDER RECORDS WHICH 4X4 BLOCKS OF THE DESTINATION IT ACTUALLY CHANGED */
+void AGMV_SetDirtyTracking(AGMV* agmv, Bool track_dirty){
+	agmv->track_dirty = track_dirty;
+	
+	if(track_dirty != TRUE && agmv->dirty != NULL){
+		free(agmv->dirty);
+		agmv->dirty = NULL;
+	}
+}
+
 AGMV* CreateAGMV(u32 num_of_frames, u32 width, u32 height, u32 frames_per_second){
 	AGMV* agmv = (AGMV*)malloc(sizeof(AGMV));
 
@@ -337,16 +609,32 @@ AGMV* CreateAGMV(u32 num_of_frames, u32 width, u32 height, u32 frames_per_second
 	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
 	agmv->bitstream->len = width*height*2;
 	agmv->bitstream->pos = 0;
+	agmv->bitstream->bitbuf = 0;
+	agmv->bitstream->bitsin = 0;
 	agmv->bitstream->data = (u8*)malloc(sizeof(u8)*agmv->bitstream->len);
+	agmv->payload = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
+	agmv->payload->data = NULL;
+	agmv->payload->len = 0;
+	agmv->payload->pos = 0;
+	agmv->payload->bitbuf = 0;
+	agmv->payload->bitsin = 0;
 	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->frame->img_data = (u32*)malloc(sizeof(u32)*width*height);
+	agmv->frame->img_data = (u32*)calloc(width*height,sizeof(u32));
 	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->iframe->img_data = (u32*)malloc(sizeof(u32)*width*height);
+	agmv->iframe->img_data = (u32*)calloc(width*height,sizeof(u32));
 	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
 	agmv->iframe_entries = (AGMV_ENTRY*)malloc(sizeof(AGMV_ENTRY)*width*height);
 	agmv->audio_track->pcm = NULL;
 	agmv->audio_track->pcm8 = NULL;
 	agmv->audio_chunk->atsample = NULL;
+	agmv->index = NULL;
+	agmv->pool = NULL;
+	agmv->encoder = NULL;
+	agmv->row_offsets = NULL;
+	agmv->dirty = NULL;
+	agmv->track_dirty = FALSE;
+	agmv->preview_iframe = NULL;
+	agmv->header.index_offset = 0;
 
 	agmv->frame_count = 0;
 	agmv->audio_track->start_point = 0;
@@ -362,12 +650,107 @@ AGMV* CreateAGMV(u32 num_of_frames, u32 width, u32 height, u32 frames_per_second
 	AGMV_SetLeniency(agmv,0.1282f);
 	AGMV_SetOPT(agmv,AGMV_OPT_I);
 	AGMV_SetCompression(agmv,AGMV_LZSS_COMPRESSION);
+	AGMV_SetMatchDepth(agmv,AGMV_DEFAULT_MATCH_DEPTH);
+	AGMV_SetLZ77Parse(agmv,AGMV_DEFAULT_LZ77_PARSE);
 	AGMV_SetVolume(agmv,1.0f);
 	AGMV_SetBitsPerSample(agmv,16);
 
 	return agmv;
 }
 
+AGMV* AGMV_AllocDecoder(){
+	AGMV* agmv = (AGMV*)malloc(sizeof(AGMV));
+	
+	agmv->frame_chunk = (AGMV_FRAME_CHUNK*)malloc(sizeof(AGMV_FRAME_CHUNK));
+	agmv->audio_chunk = (AGMV_AUDIO_CHUNK*)malloc(sizeof(AGMV_AUDIO_CHUNK));
+	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
+	agmv->bitstream->data = NULL;
+	agmv->bitstream->len = 0;
+	agmv->bitstream->pos = 0;
+	agmv->bitstream->bitbuf = 0;
+	agmv->bitstream->bitsin = 0;
+	agmv->payload = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
+	agmv->payload->data = NULL;
+	agmv->payload->len = 0;
+	agmv->payload->pos = 0;
+	agmv->payload->bitbuf = 0;
+	agmv->payload->bitsin = 0;
+	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
+	agmv->frame->img_data = NULL;
+	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
+	agmv->iframe->img_data = NULL;
+	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
+	agmv->audio_track->pcm = NULL;
+	agmv->audio_track->pcm8 = NULL;
+	agmv->audio_track->start_point = 0;
+	agmv->audio_chunk->atsample = NULL;
+	agmv->iframe_entries = NULL;
+	agmv->index = NULL;
+	agmv->pool = NULL;
+	agmv->encoder = NULL;
+	agmv->row_offsets = NULL;
+	agmv->dirty = NULL;
+	agmv->track_dirty = FALSE;
+	agmv->preview_iframe = NULL;
+	agmv->header.total_audio_duration = 0;
+	agmv->header.index_offset = 0;
+	agmv->frame_count = 0;
+	agmv->match_depth = AGMV_DEFAULT_MATCH_DEPTH;
+	agmv->lz77_parse = AGMV_DEFAULT_LZ77_PARSE;
+	
+	return agmv;
+}
+
+u32 AGMV_GetPixelSize(AGMV_PIXEL_FMT fmt){
+	switch(fmt){
+		case AGMV_PIXEL_INDEX8:{
+			return 1;
+		}
+		case AGMV_PIXEL_INDEX16:
+		case AGMV_PIXEL_RGB565:
+		case AGMV_PIXEL_RGB555:
+		case AGMV_PIXEL_BGR555:{
+			return 2;
+		}
+		default:{
+			return 4;
+		}
+	}
+}
+
+u32 AGMV_ConvertColor(u8 r, u8 g, u8 b, AGMV_PIXEL_FMT fmt){
+	switch(fmt){
+		case AGMV_PIXEL_BGRA8888:{
+			return (u32)b << 24 | (u32)g << 16 | (u32)r << 8 | 0xff;
+		}
+		case AGMV_PIXEL_RGB565:{
+			return (r >> 3) << 11 | (g >> 2) << 5 | (b >> 3);
+		}
+		case AGMV_PIXEL_RGB555:{
+			return (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3);
+		}
+		case AGMV_PIXEL_BGR555:{
+			return (b >> 3) << 10 | (g >> 3) << 5 | (r >> 3);
+		}
+		default:{
+			return (u32)r << 16 | (u32)g << 8 | b;
+		}
+	}
+}
+
+u8* AGMV_ResizeBitstream(AGMV_BITSTREAM* bitstream, u32 len){
+	if(bitstream->data == NULL || bitstream->len < len){
+		if(bitstream->data != NULL){
+			free(bitstream->data);
+		}
+		
+		bitstream->data = (u8*)malloc(sizeof(u8)*len);
+		bitstream->len = len;
+	}
+	
+	return bitstream->data;
+}
+
 void DestroyAGMV(AGMV* agmv){
 	if(agmv != NULL){
 		if(agmv->iframe_entries != NULL){
@@ -375,6 +758,37 @@ void DestroyAGMV(AGMV* agmv){
 			agmv->iframe_entries = NULL;
 		}
 		
+		if(agmv->index != NULL){
+			free(agmv->index->entries);
+			free(agmv->index);
+			agmv->index = NULL;
+		}
+		
+		if(agmv->pool != NULL){
+			AGMV_DestroyThreadPool(agmv->pool);
+			agmv->pool = NULL;
+		}
+		
+		if(agmv->encoder != NULL){
+			AGMV_DestroyEncoder(agmv->encoder);
+			agmv->encoder = NULL;
+		}
+		
+		if(agmv->row_offsets != NULL){
+			free(agmv->row_offsets);
+			agmv->row_offsets = NULL;
+		}
+		
+		if(agmv->dirty != NULL){
+			free(agmv->dirty);
+			agmv->dirty = NULL;
+		}
+		
+		if(agmv->preview_iframe != NULL){
+			free(agmv->preview_iframe);
+			agmv->preview_iframe = NULL;
+		}
+		
 		if(agmv->frame->img_data != NULL){
 			free(agmv->frame->img_data);
 			agmv->frame->img_data = NULL;
@@ -393,6 +807,12 @@ void DestroyAGMV(AGMV* agmv){
 		}
 
 		free(agmv->bitstream);
+		
+		if(agmv->payload->data != NULL){
+			free(agmv->payload->data);
+		}
+		
+		free(agmv->payload);
 		free(agmv->frame_chunk);
 		
 		if(agmv->header.total_audio_duration != 0){
@@ -470,6 +890,14 @@ AGMV_COMPRESSION AGMV_GetCompression(AGMV* agmv){
 	return agmv->compression;
 }
 
+u32 AGMV_GetMatchDepth(AGMV* agmv){
+	return agmv->match_depth;
+}
+
+AGMV_LZ_PARSE AGMV_GetLZ77Parse(AGMV* agmv){
+	return agmv->lz77_parse;
+}
+
 Bool AGMV_GetAudioState(AGMV* agmv){
 	return agmv->enable_audio;
 }
@@ -482,6 +910,82 @@ u16 AGMV_GetBitsPerSample(AGMV* agmv){
 	return agmv->header.bits_per_sample;
 }
 
+/* ((WIDTH+3)/4) * ((HEIGHT+3)/4) BYTES IN ROW ORDER, OR NULL IF NOTHING HAS BEEN RENDERED WITH TRACKING ENABLED */
+const u8* AGMV_GetDirtyBlocks(AGMV* agmv){
+	return agmv->track_dirty == TRUE ? agmv->dirty : NULL;
+}
+
+/* MERGES RUNS OF DIRTY BLOCKS INTO PIXEL RECTANGLES, JOINING RUNS THAT LINE UP WITH ONE IN THE ROW ABOVE. IF MORE THAN
+   MAX_RECTS WOULD BE NEEDED, A SINGLE BOUNDING RECTANGLE IS RETURNED INSTEAD */
+u32 AGMV_GetDirtyRects(AGMV* agmv, AGMV_RECT* rects, u32 max_rects){
+	const u8* dirty = AGMV_GetDirtyBlocks(agmv);
+	u32 width = agmv->frame->width, height = agmv->frame->height, bw = (width+3)/4, bh = (height+3)/4;
+	u32 count = 0, bx, by, start, x, w, i, minx = bw, miny = bh, maxx = 0, maxy = 0;
+	Bool overflow = FALSE, merged;
+	
+	if(dirty == NULL || max_rects == 0){
+		return 0;
+	}
+	
+	for(by = 0; by < bh; by++){
+		for(bx = 0; bx < bw; bx++){
+			if(!dirty[bx+by*bw]){
+				continue;
+			}
+			
+			start = bx;
+			
+			while(bx < bw && dirty[bx+by*bw]){
+				bx++;
+			}
+			
+			if(start < minx) minx = start;
+			if(bx > maxx) maxx = bx;
+			if(by < miny) miny = by;
+			maxy = by + 1;
+			
+			if(overflow == TRUE){
+				continue;
+			}
+			
+			x = start*4;
+			w = (bx*4 < width ? bx*4 : width) - x;
+			merged = FALSE;
+			
+			for(i = 0; i < count; i++){
+				if(rects[i].x == x && rects[i].width == w && rects[i].y + rects[i].height == by*4){
+					rects[i].height = (by*4+4 < height ? by*4+4 : height) - rects[i].y;
+					merged = TRUE;
+					break;
+				}
+			}
+			
+			if(merged != TRUE){
+				if(count == max_rects){
+					overflow = TRUE;
+					continue;
+				}
+				
+				rects[count].x = x;
+				rects[count].y = by*4;
+				rects[count].width = w;
+				rects[count].height = (by*4+4 < height ? by*4+4 : height) - by*4;
+				count++;
+			}
+		}
+	}
+	
+	if(overflow == TRUE){
+		rects[0].x = minx*4;
+		rects[0].y = miny*4;
+		rects[0].width = (maxx*4 < width ? maxx*4 : width) - minx*4;
+		rects[0].height = (maxy*4 < height ? maxy*4 : height) - miny*4;
+		count = 1;
+	}
+	
+	return count;
+}
+
 /*-----------------VARIOUS UTILITY FUNCTIONS-----------------*/
 
 u8 AGMV_GetVersionFromOPT(AGMV_OPT opt, AGMV_COMPRESSION compression){
@@ -615,6 +1119,62 @@ void AGMV_UnsigendToSignedPCM(u8* pcm, u32 size){
 	}
 }
 
+/* CAPACITY IS IN SAMPLES AND SHOULD HOLD AT LEAST ONE AUDIO CHUNK, A FEW CHUNKS GIVES THE READER ROOM TO FALL BEHIND */
+AGMV_AUDIO_RING* AGMV_CreateAudioRing(u32 capacity, u16 bits_per_sample){
+	AGMV_AUDIO_RING* ring = (AGMV_AUDIO_RING*)malloc(sizeof(AGMV_AUDIO_RING));
+	
+	if(capacity < 1){
+		capacity = 1;
+	}
+	
+	ring->bits_per_sample = bits_per_sample == 16 ? 16 : 8;
+	ring->capacity = capacity;
+	ring->data = (u8*)malloc(capacity*(ring->bits_per_sample/8));
+	ring->head = 0;
+	ring->tail = 0;
+	
+	return ring;
+}
+
+void AGMV_DestroyAudioRing(AGMV_AUDIO_RING* ring){
+	if(ring != NULL){
+		free(ring->data);
+		free(ring);
+	}
+}
+
+u32 AGMV_GetAudioRingCount(AGMV_AUDIO_RING* ring){
+	return AGMV_AtomicLoad(&ring->head) - AGMV_AtomicLoad(&ring->tail);
+}
+
+u32 AGMV_GetAudioRingSpace(AGMV_AUDIO_RING* ring){
+	return ring->capacity - AGMV_GetAudioRingCount(ring);
+}
+
+/* COPIES UP TO NUM_OF_SAMPLES OF THE OLDEST DECODED SAMPLES INTO DEST AND RETURNS HOW MANY WERE COPIED */
+u32 AGMV_ReadAudioRing(AGMV_AUDIO_RING* ring, void* dest, u32 num_of_samples){
+	u32 tail = ring->tail, count = AGMV_AtomicLoad(&ring->head) - tail, bytes = ring->bits_per_sample/8, start, first;
+	u8* out = (u8*)dest;
+	
+	if(num_of_samples > count){
+		num_of_samples = count;
+	}
+	
+	start = tail % ring->capacity;
+	first = ring->capacity - start;
+	
+	if(first > num_of_samples){
+		first = num_of_samples;
+	}
+	
+	memcpy(out,ring->data + start*bytes,first*bytes);
+	memcpy(out + first*bytes,ring->data,(num_of_samples-first)*bytes);
+	
+	AGMV_AtomicStore(&ring->tail,tail+num_of_samples);
+	
+	return num_of_samples;
+}
+
 int AGMV_Abs(int a){
 	if(a < 0){
 		return -a;
@@ -1010,6 +1570,173 @@ void AGMV_BubbleSort(u32* data, u32* gram, u32 num_of_colors){
 }
 
 
+/* STABLE LSD RADIX SORT, 16 BITS A PASS, WITH GRAM MOVED ALONG WITH DATA. EQUAL COUNTS KEEP THEIR ORDER, SO THE RESULT IS EXACTLY
+   WHAT AGMV_BubbleSort PRODUCES, IN ONE TO THREE LINEAR PASSES OVER THE HISTOGRAM INSTEAD OF N^2 COMPARISONS */
+void AGMV_RadixSort(u32* data, u32* gram, u32 num_of_colors){
+	u32 i, d, sum, max = 0, shift, *count, *src_data = data, *src_gram = gram, *dst_data, *dst_gram, *temp;
+	
+	if(num_of_colors < 2){
+		return;
+	}
+	
+	for(i = 0; i < num_of_colors; i++){
+		if(data[i] > max){
+			max = data[i];
+		}
+	}
+	
+	count = (u32*)malloc(sizeof(u32)*65536);
+	dst_data = (u32*)malloc(sizeof(u32)*num_of_colors);
+	dst_gram = (u32*)malloc(sizeof(u32)*num_of_colors);
+	
+	for(shift = 0; shift < sizeof(u32)*8 && (max >> shift) != 0; shift += 16){
+		memset(count,0,sizeof(u32)*65536);
+		
+		for(i = 0; i < num_of_colors; i++){
+			count[(src_data[i] >> shift) & 0xFFFF]++;
+		}
+		
+		for(d = 0, sum = 0; d < 65536; d++){
+			u32 n = count[d];
+			count[d] = sum;
+			sum += n;
+		}
+		
+		for(i = 0; i < num_of_colors; i++){
+			u32 pos = count[(src_data[i] >> shift) & 0xFFFF]++;
+			dst_data[pos] = src_data[i];
+			dst_gram[pos] = src_gram[i];
+		}
+		
+		temp = src_data; src_data = dst_data; dst_data = temp;
+		temp = src_gram; src_gram = dst_gram; dst_gram = temp;
+	}
+	
+	if(src_data != data){
+		memcpy(data,src_data,sizeof(u32)*num_of_colors);
+		memcpy(gram,src_gram,sizeof(u32)*num_of_colors);
+		dst_data = src_data;
+		dst_gram = src_gram;
+	}
+	
+	free(count);
+	free(dst_data);
+	free(dst_gram);
+}
+
+/* THE ENCODERS' PALETTE BUILDER. HISTOGRAM HOLDS A COUNT FOR EACH OF THE MAX_CLR QUANTIZED COLORS AND IS SORTED IN PLACE. THE MOST
+   FREQUENT COLORS THAT ARE NOT TOO CLOSE TO ONE ALREADY PICKED FILL UP TO 512 SLOTS, WHICH ARE THEN SPLIT ACROSS THE PALETTES OPT USES */
+void AGMV_BuildPalettes(u32* histogram, u32 max_clr, AGMV_QUALITY quality, AGMV_OPT opt, u32 palette0[256], u32 palette1[256]){
+	u32 i, n, count = 0, pal[512];
+	u32* colorgram = (u32*)malloc(sizeof(u32)*(max_clr+1));
+	
+	for(i = 0; i < 512; i++){
+		if(i < 256){
+			palette0[i] = 0;
+			palette1[i] = 0;
+		}
+		
+		pal[i] = 0;
+	}
+	
+	for(i = 0; i < max_clr; i++){
+		colorgram[i] = i;
+	}
+	
+	/* THE SEARCH STARTS ONE PAST THE SORTED COLORS, SO BLACK IS ALWAYS THE FIRST CANDIDATE */
+	colorgram[max_clr] = 0;
+	
+	AGMV_RadixSort(histogram,colorgram,max_clr);
+	
+	for(n = max_clr; n > 0; n--){
+		Bool skip = FALSE;
+			
+		u32 clr = colorgram[n];
+		
+		int r = AGMV_GetQuantizedR(clr,quality);
+		int g = AGMV_GetQuantizedG(clr,quality);
+		int b = AGMV_GetQuantizedB(clr,quality);
+		
+		int j;
+		for(j = 0; j < 512; j++){
+			u32 palclr = pal[j];
+			
+			int palr = AGMV_GetQuantizedR(palclr,quality);
+			int palg = AGMV_GetQuantizedG(palclr,quality);
+			int palb = AGMV_GetQuantizedB(palclr,quality);
+			
+			int rdiff = r-palr;
+			int gdiff = g-palg;
+			int bdiff = b-palb;
+			
+			if(rdiff < 0){
+				rdiff = AGMV_Abs(rdiff);
+			}
+			
+			if(gdiff < 0){
+				gdiff = AGMV_Abs(gdiff);
+			}
+			
+			if(bdiff < 0){
+				bdiff = AGMV_Abs(bdiff);
+			}
+			
+			if(quality == AGMV_HIGH_QUALITY){
+				if(rdiff <= 2 && gdiff <= 2 && bdiff <= 3){
+					skip = TRUE;
+				}
+			}
+			else{
+				if(rdiff <= 1 && gdiff <= 1 && bdiff <= 1){
+					skip = TRUE;
+				}
+			}
+		}
+		
+		if(skip == FALSE){
+			pal[count] = clr;
+			count++;
+		}
+		
+		if(count >= 512){
+			break;
+		}
+	}
+	
+	if(opt == AGMV_OPT_I || opt == AGMV_OPT_GBA_I || opt == AGMV_OPT_III || opt == AGMV_OPT_GBA_III || opt == AGMV_OPT_NDS){
+		for(n = 0; n < 512; n++){
+			u32 clr = pal[n];
+			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
+			
+			if(n < 126){
+				palette0[n] = invclr;
+			}
+			else if(n >= 126 && n <= 252){
+				palette1[n-126] = invclr;
+			}
+			
+			if(n > 252 && n <= 381){
+				palette0[n-126] = invclr;
+			}
+			
+			if(n > 381 && (n-255) < 256){
+				palette1[n-255] = invclr;
+			}
+		}
+	}
+	
+	if(opt == AGMV_OPT_II || opt == AGMV_OPT_GBA_II|| opt == AGMV_OPT_ANIM){
+		for(n = 0; n < 256; n++){
+			u32 clr = pal[n];
+			u32 invclr = AGMV_ReverseQuantizeColor(clr,quality);
+			
+			palette0[n] = invclr;
+		}
+	}
+	
+	free(colorgram);
+}
+
 char* AGMV_Error2Str(Error error){
 	switch(error){
 		case NO_ERR:{
@@ -1024,6 +1751,9 @@ char* AGMV_Error2Str(Error error){
 		case MEMORY_CORRUPTION_ERR:{
 			return "MEMORY CORRUPTION ERROR";
 		}
+		case BUFFER_FULL_ERR:{
+			return "BUFFER FULL ERROR";
+		}
 	}
 	return "INVALID ERROR CODE";
 }
@@ -1400,7 +2130,8 @@ int AGMV_ResetFrameRate(const char* filename, u32 frames_per_second){
 
 void to_80bitfloat(u32 num, u8 bytes[10]);
 
-void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
+/* WRITES EVERYTHING UP TO THE FIRST SAMPLE. THE SIZES COME FROM THE MAIN HEADER, SO AUDIO_SIZE SAMPLES MUST FOLLOW */
+void AGMV_ExportAudioHeader(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
 	int i;
 	u8 bytes[10];
 	switch(audio_type){
@@ -1427,11 +2158,9 @@ void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
 			
 			if(agmv->header.bits_per_sample == 16){
 				AGMV_WriteLong(audio,agmv->header.audio_size*2);
-				fwrite(agmv->audio_track->pcm,2,agmv->header.audio_size,audio);
 			}
 			else{
 				AGMV_WriteLong(audio,agmv->header.audio_size);
-				fwrite(agmv->audio_track->pcm8,1,agmv->header.audio_size,audio);
 			}
 		}break;
 		case AGMV_AUDIO_AIFF:{
@@ -1478,17 +2207,6 @@ void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
 			
 			AGMV_WriteLong(audio,0);
 			AGMV_WriteLong(audio,0);
-			
-			if(AGMV_GetBitsPerSample(agmv) == 16){
-				for(i = 0; i < AGMV_GetAudioSize(agmv); i++){
-					AGMV_WriteShort(audio,AGMV_SwapShort(agmv->audio_track->pcm[i]));
-				}
-			}
-			else{
-				for(i = 0; i < AGMV_GetAudioSize(agmv); i++){
-					AGMV_WriteByte(audio,agmv->audio_track->pcm8[i]-128);
-				}
-			}
 		}break;
 		case AGMV_AUDIO_AIFC:{
 			AGMV_WriteFourCC(audio,'F','O','R','M');
@@ -1529,17 +2247,6 @@ void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
 			
 			AGMV_WriteLong(audio,0);
 			AGMV_WriteLong(audio,0);
-			
-			if(AGMV_GetBitsPerSample(agmv) == 16){
-				for(i = 0; i < AGMV_GetAudioSize(agmv); i++){
-					AGMV_WriteShort(audio,AGMV_SwapShort(agmv->audio_track->pcm[i]));
-				}
-			}
-			else{
-				for(i = 0; i < AGMV_GetAudioSize(agmv); i++){
-					AGMV_WriteByte(audio,agmv->audio_track->pcm8[i]-128);
-				}
-			}
 		}break;
 		default:{
 			AGMV_WriteFourCC(audio,'R','I','F','F');
@@ -1564,16 +2271,56 @@ void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
 			
 			if(agmv->header.bits_per_sample == 16){
 				AGMV_WriteLong(audio,agmv->header.audio_size*2);
-				fwrite(agmv->audio_track->pcm,2,agmv->header.audio_size,audio);
 			}
 			else{
 				AGMV_WriteLong(audio,agmv->header.audio_size);
-				fwrite(agmv->audio_track->pcm8,1,agmv->header.audio_size,audio);
 			}
 		}break;
 	}
 }
 
+/* APPENDS NUM_OF_SAMPLES DECODED SAMPLES IN THE BYTE ORDER AND SIGNEDNESS OF THE CONTAINER STARTED BY AGMV_ExportAudioHeader */
+void AGMV_ExportAudioSamples(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type, const void* pcm, u32 num_of_samples){
+	const u16* pcm16 = (const u16*)pcm;
+	const u8* pcm8 = (const u8*)pcm;
+	u32 i;
+	
+	switch(audio_type){
+		case AGMV_AUDIO_AIFF:
+		case AGMV_AUDIO_AIFC:{
+			if(AGMV_GetBitsPerSample(agmv) == 16){
+				for(i = 0; i < num_of_samples; i++){
+					AGMV_WriteShort(audio,AGMV_SwapShort(pcm16[i]));
+				}
+			}
+			else{
+				for(i = 0; i < num_of_samples; i++){
+					AGMV_WriteByte(audio,pcm8[i]-128);
+				}
+			}
+		}break;
+		default:{
+			if(agmv->header.bits_per_sample == 16){
+				fwrite(pcm16,2,num_of_samples,audio);
+			}
+			else{
+				fwrite(pcm8,1,num_of_samples,audio);
+			}
+		}break;
+	}
+}
+
+void AGMV_ExportAudioType(FILE* audio, AGMV* agmv, AGMV_AUDIO_TYPE audio_type){
+	AGMV_ExportAudioHeader(audio,agmv,audio_type);
+	
+	if(agmv->header.bits_per_sample == 16){
+		AGMV_ExportAudioSamples(audio,agmv,audio_type,agmv->audio_track->pcm,agmv->header.audio_size);
+	}
+	else{
+		AGMV_ExportAudioSamples(audio,agmv,audio_type,agmv->audio_track->pcm8,agmv->header.audio_size);
+	}
+}
+
 void AGMV_ExportAGMVToHeader(const char* filename){
 	FILE* in, *out;
 	u32 file_size, i;
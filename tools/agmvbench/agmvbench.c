@@ -0,0 +1,624 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <agmv.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+/********************************************
+*   Adaptive Graphics Motion Video
+*
+*   Copyright (c) 2024 Ryandracus Chapman
+*
+*   Library: libagmv
+*   File: agmvbench.c
+*   Date: 10/17/2026
+*   Version: 1.1
+*   Updated: 10/17/2026
+*   Author: Ryandracus Chapman
+*
+********************************************/
+
+/* HEADLESS DECODE/ENCODE BENCHMARK. EVERYTHING IS REPORTED AS ONE JSON OBJECT SO RESULTS CAN BE DIFFED BETWEEN RELEASES */
+
+typedef struct BENCH_CONFIG{
+	u32 iterations;
+	u32 threads;
+	const char* simd;
+	Bool encode;
+	u32 enc_width;
+	u32 enc_height;
+	u32 enc_frames;
+	AGMV_QUALITY quality;
+	AGMV_COMPRESSION compression;
+	AGMV_OPT opt;
+	u32 match_depth;
+	AGMV_LZ_PARSE parse;
+	const char* clip_dir;
+	const char* clip_basename;
+	u8 clip_img_type;
+	u32 clip_start;
+	u32 clip_end;
+	u32 clip_width;
+	u32 clip_height;
+}BENCH_CONFIG;
+
+/* MONOTONIC NANOSECONDS */
+double BenchNow(){
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+void PrintJSONString(FILE* out, const char* str){
+	fputc('"',out);
+
+	for(; *str != '\0'; str++){
+		if(*str == '"' || *str == '\\'){
+			fputc('\\',out);
+		}
+		fputc(*str,out);
+	}
+
+	fputc('"',out);
+}
+
+/* DECODES EVERY FRAME OF A FILE ITERATIONS TIMES, TIMING LZ EXPANSION AND BLOCK RECONSTRUCTION SEPARATELY */
+Bool BenchDecode(FILE* out, const char* filename, BENCH_CONFIG* config, Bool first){
+	AGMV_MAPPED_FILE* file = AGMV_OpenMapped(filename);
+	AGMV* agmv;
+	const u8* payload;
+	u32 width, height, size, stride, num_of_frames, frames = 0, start, csize, bpos, iter, i;
+	double in_bytes = 0, t0, t1, t2, begin, total = 0, lz = 0, render = 0, best = 0, elapsed;
+	Bool has_audio;
+
+	if(file == NULL){
+		return FALSE;
+	}
+
+	agmv = AGMV_AllocDecoder();
+
+	if(AGMV_DecodeMappedHeader(file,agmv) != NO_ERR){
+		AGMV_CloseMapped(file);
+		DestroyAGMV(agmv);
+		return FALSE;
+	}
+
+	width = agmv->header.width;
+	height = agmv->header.height;
+	size = width*height;
+	stride = width*sizeof(u32);
+	num_of_frames = AGMV_GetNumberOfFrames(agmv);
+	has_audio = agmv->header.total_audio_duration != 0;
+	start = AGMV_MappedTell(file);
+
+	agmv->frame->width = width;
+	agmv->frame->height = height;
+	agmv->frame->img_data = (u32*)calloc(size,sizeof(u32));
+	agmv->iframe->width = width;
+	agmv->iframe->height = height;
+	agmv->iframe->img_data = (u32*)calloc(size,sizeof(u32));
+	AGMV_ResizeBitstream(agmv->bitstream,size*2);
+
+	AGMV_SetDecodeThreads(agmv,config->threads);
+
+	for(iter = 0; iter < config->iterations; iter++){
+		AGMV_MappedSeek(file,start,SEEK_SET);
+		agmv->frame_count = 0;
+		begin = BenchNow();
+
+		for(i = 0; i < num_of_frames; i++){
+			AGMV_MappedFindNextFrameChunk(file);
+
+			if(AGMV_ReadMappedFrameChunk(file,agmv,&payload,&csize) != NO_ERR){
+				break;
+			}
+
+			t0 = BenchNow();
+			bpos = AGMV_DecompressFrame(agmv,payload,csize);
+			t1 = BenchNow();
+			AGMV_RenderFrame(agmv,agmv->bitstream->data,bpos,(u8*)agmv->frame->img_data,stride,sizeof(u32),agmv->header.palette0,agmv->header.palette1,(const u8*)agmv->iframe->img_data,stride);
+
+			if(agmv->frame_count % 4 == 0){
+				memcpy(agmv->iframe->img_data,agmv->frame->img_data,sizeof(u32)*size);
+			}
+
+			agmv->frame_count++;
+			t2 = BenchNow();
+
+			lz += t1 - t0;
+			render += t2 - t1;
+			in_bytes += csize;
+
+			if(has_audio){
+				AGMV_MappedFindNextAudioChunk(file);
+				AGMV_MappedSkipAudioChunk(file);
+			}
+		}
+
+		elapsed = BenchNow() - begin;
+		total += elapsed;
+		frames += i;
+
+		if(i > 0 && (best == 0 || elapsed / i < best)){
+			best = elapsed / i;
+		}
+	}
+
+	if(frames == 0){
+		frames = 1;
+	}
+
+	if(total <= 0){
+		total = 1;
+	}
+
+	fprintf(out,"%s\n\t\t{\n\t\t\t\"file\": ",first ? "" : ",");
+	PrintJSONString(out,filename);
+	fprintf(out,",\n\t\t\t\"width\": %lu,\n\t\t\t\"height\": %lu,\n\t\t\t\"version\": %d,\n\t\t\t\"frames\": %lu,\n\t\t\t\"iterations\": %lu,\n",width,height,agmv->header.version,num_of_frames,config->iterations);
+	fprintf(out,"\t\t\t\"fps\": %.3f,\n",frames * 1e9 / total);
+	fprintf(out,"\t\t\t\"ns_per_frame\": %.1f,\n",total / frames);
+	fprintf(out,"\t\t\t\"best_ns_per_frame\": %.1f,\n",best);
+	fprintf(out,"\t\t\t\"input_mb_per_s\": %.3f,\n",in_bytes / (1024.0*1024.0) / (total / 1e9));
+	fprintf(out,"\t\t\t\"output_mb_per_s\": %.3f,\n",(double)frames * size * 4 / (1024.0*1024.0) / (total / 1e9));
+	fprintf(out,"\t\t\t\"lz_ns_per_frame\": %.1f,\n",lz / frames);
+	fprintf(out,"\t\t\t\"render_ns_per_frame\": %.1f,\n",render / frames);
+	fprintf(out,"\t\t\t\"lz_share\": %.4f,\n",lz / total);
+	fprintf(out,"\t\t\t\"render_share\": %.4f\n\t\t}",render / total);
+
+	AGMV_CloseMapped(file);
+	DestroyAGMV(agmv);
+
+	return TRUE;
+}
+
+/* DETERMINISTIC REFERENCE CLIP: A SCROLLING GRADIENT WITH A MOVING BOX AND A LITTLE NOISE, SO BOTH FILL AND NORMAL BLOCKS OCCUR */
+void GenerateClip(u32* frame, u32 width, u32 height, u32 n){
+	u32 x, y, seed = 0x1234567 + n*7919, bx = (n*6) % width, by = (n*3) % height;
+	u8 r, g, b;
+
+	for(y = 0; y < height; y++){
+		for(x = 0; x < width; x++){
+			seed = seed * 1103515245 + 12345;
+			r = (x + n*2) & 0xff;
+			g = (y*2 + n) & 0xff;
+			b = ((x ^ y) + (seed >> 27)) & 0xff;
+
+			if(x >= bx && x < bx + width/4 && y >= by && y < by + height/4){
+				r = 0xf0; g = 0x40; b = 0x20;
+			}
+
+			frame[x+y*width] = r << 16 | g << 8 | b;
+		}
+	}
+}
+
+/* HISTOGRAMS THE FRAMES LIKE THE ENCODER HISTOGRAMS ITS IMAGES, THEN BUILDS THE PALETTES WITH THE ENCODER'S OWN AGMV_BuildPalettes */
+void BuildPalettes(u32** frames, u32 num_of_frames, u32 size, AGMV_QUALITY quality, AGMV_OPT opt, u32 palette0[256], u32 palette1[256]){
+	u32 max_clr, i, n;
+	u32* histogram;
+
+	switch(quality){
+		case AGMV_MID_QUALITY: max_clr = 131071; break;
+		case AGMV_LOW_QUALITY: max_clr = 65535; break;
+		default: max_clr = AGMV_MAX_CLR; break;
+	}
+
+	histogram = (u32*)malloc(sizeof(u32)*(max_clr+1));
+
+	for(i = 0; i < max_clr; i++){
+		histogram[i] = 1;
+	}
+
+	for(n = 0; n < num_of_frames; n++){
+		for(i = 0; i < size; i++){
+			histogram[AGMV_QuantizeColor(frames[n][i],quality)]++;
+		}
+	}
+
+	AGMV_BuildPalettes(histogram,max_clr,quality,opt,palette0,palette1);
+
+	free(histogram);
+}
+
+AGMV* CreateBenchEncoder(BENCH_CONFIG* config, u32 palette0[256], u32 palette1[256]){
+	AGMV* agmv = CreateAGMV(config->enc_frames,config->enc_width,config->enc_height,24);
+
+	AGMV_SetOPT(agmv,config->opt);
+	AGMV_SetCompression(agmv,config->compression);
+	AGMV_SetMatchDepth(agmv,config->match_depth);
+	AGMV_SetLZ77Parse(agmv,config->parse);
+	AGMV_SetLeniency(agmv,0.2282);
+	AGMV_SetICP0(agmv,palette0);
+	AGMV_SetICP1(agmv,palette1);
+
+	return agmv;
+}
+
+/* TIMES EACH STAGE OF AGMV_EncodeFrame THROUGH THE SAME PUBLIC STEPS IT TAKES, THEN THE WHOLE FUNCTION END TO END */
+void BenchEncode(FILE* out, BENCH_CONFIG* config){
+	u32 width = config->enc_width, height = config->enc_height, size = width*height, n, i;
+	u32 palette0[256], palette1[256];
+	u32** frames = (u32**)malloc(sizeof(u32*)*config->enc_frames);
+	AGMV_ENTRY* img_entry = (AGMV_ENTRY*)malloc(sizeof(AGMV_ENTRY)*size);
+	double t0, t1, palette, map = 0, assemble = 0, compress = 0, encode;
+	u32 out_bytes, lz_bytes = 0, bits = 0;
+	Bool two_palettes = config->opt != AGMV_OPT_II && config->opt != AGMV_OPT_ANIM && config->opt != AGMV_OPT_GBA_II;
+	AGMV* agmv;
+	FILE* file;
+
+	for(n = 0; n < config->enc_frames; n++){
+		frames[n] = (u32*)malloc(sizeof(u32)*size);
+		GenerateClip(frames[n],width,height,n);
+	}
+
+	t0 = BenchNow();
+	BuildPalettes(frames,config->enc_frames,size,config->quality,config->opt,palette0,palette1);
+	palette = BenchNow() - t0;
+
+	agmv = CreateBenchEncoder(config,palette0,palette1);
+	file = tmpfile();
+	AGMV_EncodeHeader(file,agmv);
+
+	for(n = 0; n < config->enc_frames; n++){
+		t0 = BenchNow();
+
+		AGMV_SyncFrameAndImage(agmv,frames[n]);
+
+		if(two_palettes){
+			for(i = 0; i < size; i++){
+				img_entry[i] = AGMV_FindNearestEntry(palette0,palette1,frames[n][i]);
+			}
+		}
+		else{
+			for(i = 0; i < size; i++){
+				img_entry[i].index = AGMV_FindNearestColor(palette0,frames[n][i]);
+				img_entry[i].pal_num = 0;
+			}
+		}
+
+		t1 = BenchNow();
+		map += t1 - t0;
+
+		agmv->bitstream->pos = 0;
+
+		if(agmv->frame_count % 4 == 0){
+			AGMV_AssembleIFrameBitstream(agmv,img_entry);
+		}
+		else{
+			AGMV_AssemblePFrameBitstream(agmv,img_entry);
+		}
+
+		t0 = BenchNow();
+		assemble += t0 - t1;
+		bits += agmv->bitstream->pos;
+
+		agmv->payload->pos = 0;
+		agmv->payload->bitbuf = 0;
+		agmv->payload->bitsin = 0;
+
+		if(config->compression == AGMV_LZSS_COMPRESSION){
+			lz_bytes += AGMV_CompressLZSS(agmv->payload,agmv->bitstream,AGMV_GetMatchDepth(agmv));
+		}
+		else{
+			lz_bytes += AGMV_CompressLZ77(agmv->payload,agmv->bitstream,AGMV_GetMatchDepth(agmv),AGMV_GetLZ77Parse(agmv));
+		}
+
+		fwrite(agmv->payload->data,1,agmv->payload->pos,file);
+
+		t1 = BenchNow();
+		compress += t1 - t0;
+
+		if(agmv->frame_count % 4 == 0){
+			memcpy(agmv->iframe_entries,img_entry,sizeof(AGMV_ENTRY)*size);
+		}
+
+		agmv->frame_count++;
+	}
+
+	fclose(file);
+	DestroyAGMV(agmv);
+
+	agmv = CreateBenchEncoder(config,palette0,palette1);
+	AGMV_SetEncodeThreads(agmv,config->threads);
+	file = tmpfile();
+	AGMV_EncodeHeader(file,agmv);
+
+	t0 = BenchNow();
+
+	for(n = 0; n < config->enc_frames; n++){
+		AGMV_EncodeFrame(file,agmv,frames[n]);
+	}
+	
+	AGMV_FlushEncoder(file,agmv);
+
+	encode = BenchNow() - t0;
+	out_bytes = ftell(file);
+
+	fclose(file);
+	DestroyAGMV(agmv);
+
+	fprintf(out,"\t\"encode\": {\n");
+	fprintf(out,"\t\t\"width\": %lu,\n\t\t\"height\": %lu,\n\t\t\"frames\": %lu,\n",width,height,config->enc_frames);
+	fprintf(out,"\t\t\"quality\": \"%s\",\n",config->quality == AGMV_HIGH_QUALITY ? "HIGH" : config->quality == AGMV_MID_QUALITY ? "MID" : "LOW");
+	fprintf(out,"\t\t\"compression\": \"%s\",\n",config->compression == AGMV_LZ77_COMPRESSION ? "LZ77" : "LZSS");
+	fprintf(out,"\t\t\"palettes\": %d,\n",two_palettes ? 2 : 1);
+	fprintf(out,"\t\t\"match_depth\": %lu,\n",config->match_depth);
+	fprintf(out,"\t\t\"parse\": \"%s\",\n",config->parse == AGMV_PARSE_GREEDY ? "greedy" : "optimal");
+	fprintf(out,"\t\t\"palette_ms\": %.3f,\n",palette / 1e6);
+	fprintf(out,"\t\t\"map_ns_per_frame\": %.1f,\n",map / config->enc_frames);
+	fprintf(out,"\t\t\"assemble_ns_per_frame\": %.1f,\n",assemble / config->enc_frames);
+	fprintf(out,"\t\t\"compress_ns_per_frame\": %.1f,\n",compress / config->enc_frames);
+	fprintf(out,"\t\t\"bitstream_bytes_per_frame\": %.1f,\n",(double)bits / config->enc_frames);
+	fprintf(out,"\t\t\"compressed_bytes_per_frame\": %.1f,\n",(double)lz_bytes / config->enc_frames);
+	fprintf(out,"\t\t\"encode_frame_ns_per_frame\": %.1f,\n",encode / config->enc_frames);
+	fprintf(out,"\t\t\"encode_fps\": %.3f,\n",config->enc_frames * 1e9 / (encode > 0 ? encode : 1));
+	fprintf(out,"\t\t\"output_bytes\": %lu\n\t}",out_bytes);
+
+	for(n = 0; n < config->enc_frames; n++){
+		free(frames[n]);
+	}
+
+	free(frames);
+	free(img_entry);
+}
+
+/* A NEW EMPTY FILE IN THE SYSTEM TEMP DIRECTORY, SO THE CLIP ENCODE LEAVES NOTHING IN THE WORKING DIRECTORY */
+Bool CreateTempPath(char* path, u32 size){
+#ifdef _WIN32
+	char dir[MAX_PATH];
+
+	if(size < MAX_PATH || GetTempPathA(MAX_PATH,dir) == 0 || GetTempFileNameA(dir,"agb",0,path) == 0){
+		return FALSE;
+	}
+
+	return TRUE;
+#else
+	const char* dir = getenv("TMPDIR");
+	int fd;
+
+	if(dir == NULL || dir[0] == '\0'){
+		dir = "/tmp";
+	}
+
+	if(snprintf(path,size,"%s/agmvbench_XXXXXX",dir) >= (int)size){
+		return FALSE;
+	}
+
+	fd = mkstemp(path);
+
+	if(fd < 0){
+		return FALSE;
+	}
+
+	close(fd);
+	return TRUE;
+#endif
+}
+
+/* A FULL AGMV_EncodeAGMV RUN OVER A CLIP OF IMAGE FILES ON DISK, INCLUDING IMAGE LOADING AND FRAME SKIPPING */
+void BenchClip(FILE* out, BENCH_CONFIG* config){
+	u32 frames = config->clip_end - config->clip_start + 1;
+	double t0, elapsed;
+	FILE* file;
+	long bytes = 0;
+	char path[512];
+	AGMV* agmv;
+
+	if(CreateTempPath(path,sizeof(path)) != TRUE){
+		printf("Could not create a temporary file for the clip encode!\n");
+		return;
+	}
+
+	t0 = BenchNow();
+	agmv = CreateAGMV(config->clip_end-config->clip_start,config->clip_width,config->clip_height,24);
+	AGMV_SetMatchDepth(agmv,config->match_depth);
+	AGMV_SetLZ77Parse(agmv,config->parse);
+	AGMV_EncodeAGMV(agmv,path,config->clip_dir,config->clip_basename,config->clip_img_type,config->clip_start,config->clip_end,config->clip_width,config->clip_height,24,config->opt,config->quality,config->compression);
+	elapsed = BenchNow() - t0;
+
+	file = fopen(path,"rb");
+
+	if(file != NULL){
+		fseek(file,0,SEEK_END);
+		bytes = ftell(file);
+		fclose(file);
+	}
+
+	remove(path);
+
+	fprintf(out,",\n\t\"clip\": {\n\t\t\"dir\": ");
+	PrintJSONString(out,config->clip_dir);
+	fprintf(out,",\n\t\t\"frames\": %lu,\n",frames);
+	fprintf(out,"\t\t\"total_ms\": %.3f,\n",elapsed / 1e6);
+	fprintf(out,"\t\t\"fps\": %.3f,\n",frames * 1e9 / (elapsed > 0 ? elapsed : 1));
+	fprintf(out,"\t\t\"output_bytes\": %ld\n\t}",bytes);
+}
+
+u8 GetImageType(const char* ext){
+	const char* names[] = {"BMP","TGA","TIM","PCX","LMP","PVR","GXT","BTI","3DF","PPM","LBM"};
+	u8 i;
+
+	for(i = 0; i < 11; i++){
+		if(strcmp(ext,names[i]) == 0){
+			return i + 1;
+		}
+	}
+
+	return AGMV_IMG_BMP;
+}
+
+AGMV_SIMD GetSIMD(const char* name){
+	if(strcmp(name,"none") == 0) return AGMV_SIMD_NONE;
+	if(strcmp(name,"sse2") == 0) return AGMV_SIMD_SSE2;
+	if(strcmp(name,"avx2") == 0) return AGMV_SIMD_AVX2;
+	if(strcmp(name,"neon") == 0) return AGMV_SIMD_NEON;
+	return AGMV_GetSIMD();
+}
+
+const char* GetSIMDName(AGMV_SIMD simd){
+	switch(simd){
+		case AGMV_SIMD_SSE2: return "sse2";
+		case AGMV_SIMD_AVX2: return "avx2";
+		case AGMV_SIMD_NEON: return "neon";
+		default: return "none";
+	}
+}
+
+int main(int argc, char* argv[]){
+	char* usage =
+	"\nAGMVBENCH - Adaptive Graphics Motion Video Benchmark\n\n"
+	"USAGE: agmvbench [OPTIONS] [FILE.AGMV ...]\n\n"
+	"-i N                        decode iterations per file (default 3)\n"
+	"-t N                        decode and encode threads, 0 = one per core (default 1)\n"
+	"-simd none|sse2|avx2|neon   block kernels (default best available)\n"
+	"-enc WIDTH HEIGHT FRAMES    size of the synthetic reference clip (default 160 120 24)\n"
+	"-q HIGH|MID|LOW             encoder quality (default LOW)\n"
+	"-c LZSS|LZ77                encoder compression (default LZSS)\n"
+	"-pal 1|2                    encode with one or two palettes (default 2)\n"
+	"-depth N                    match finder search depth, 0 = exhaustive (default library setting)\n"
+	"-parse greedy|optimal       LZ77 parsing (default library setting)\n"
+	"-noenc                      skip the encoder benchmark\n"
+	"-clip DIR BASENAME IMG START END WIDTH HEIGHT   also time AGMV_EncodeAGMV on a clip of image files\n"
+	"-o FILE                     write the JSON report to FILE instead of stdout\n";
+
+	BENCH_CONFIG config;
+	FILE* out = stdout;
+	const char** files = (const char**)malloc(sizeof(char*)*(argc+1));
+	u32 num_of_files = 0, i;
+	int a;
+	Bool first = TRUE;
+
+	config.iterations = 3;
+	config.threads = 1;
+	config.simd = NULL;
+	config.encode = TRUE;
+	config.enc_width = 160;
+	config.enc_height = 120;
+	config.enc_frames = 24;
+	config.quality = AGMV_LOW_QUALITY;
+	config.compression = AGMV_LZSS_COMPRESSION;
+	config.opt = AGMV_OPT_III;
+	config.match_depth = AGMV_DEFAULT_MATCH_DEPTH;
+	config.parse = AGMV_DEFAULT_LZ77_PARSE;
+	config.clip_dir = NULL;
+
+	for(a = 1; a < argc; a++){
+		if(strcmp(argv[a],"-i") == 0 && a + 1 < argc){
+			config.iterations = atoi(argv[++a]);
+		}
+		else if(strcmp(argv[a],"-t") == 0 && a + 1 < argc){
+			config.threads = atoi(argv[++a]);
+		}
+		else if(strcmp(argv[a],"-simd") == 0 && a + 1 < argc){
+			config.simd = argv[++a];
+		}
+		else if(strcmp(argv[a],"-enc") == 0 && a + 3 < argc){
+			config.enc_width = atoi(argv[++a]) & ~3;
+			config.enc_height = atoi(argv[++a]) & ~3;
+			config.enc_frames = atoi(argv[++a]);
+		}
+		else if(strcmp(argv[a],"-q") == 0 && a + 1 < argc){
+			a++;
+			config.quality = strcmp(argv[a],"HIGH") == 0 ? AGMV_HIGH_QUALITY : strcmp(argv[a],"MID") == 0 ? AGMV_MID_QUALITY : AGMV_LOW_QUALITY;
+		}
+		else if(strcmp(argv[a],"-c") == 0 && a + 1 < argc){
+			config.compression = strcmp(argv[++a],"LZ77") == 0 ? AGMV_LZ77_COMPRESSION : AGMV_LZSS_COMPRESSION;
+		}
+		else if(strcmp(argv[a],"-pal") == 0 && a + 1 < argc){
+			config.opt = atoi(argv[++a]) == 1 ? AGMV_OPT_II : AGMV_OPT_III;
+		}
+		else if(strcmp(argv[a],"-depth") == 0 && a + 1 < argc){
+			config.match_depth = atoi(argv[++a]);
+		}
+		else if(strcmp(argv[a],"-parse") == 0 && a + 1 < argc){
+			a++;
+			config.parse = strcmp(argv[a],"greedy") == 0 ? AGMV_PARSE_GREEDY : AGMV_PARSE_OPTIMAL;
+		}
+		else if(strcmp(argv[a],"-noenc") == 0){
+			config.encode = FALSE;
+		}
+		else if(strcmp(argv[a],"-clip") == 0 && a + 7 < argc){
+			config.clip_dir = argv[++a];
+			config.clip_basename = argv[++a];
+			config.clip_img_type = GetImageType(argv[++a]);
+			config.clip_start = atoi(argv[++a]);
+			config.clip_end = atoi(argv[++a]);
+			config.clip_width = atoi(argv[++a]);
+			config.clip_height = atoi(argv[++a]);
+		}
+		else if(strcmp(argv[a],"-o") == 0 && a + 1 < argc){
+			out = fopen(argv[++a],"w");
+
+			if(out == NULL){
+				printf("Could not open %s!\n",argv[a]);
+				return 1;
+			}
+		}
+		else if(argv[a][0] == '-'){
+			printf("%s",usage);
+			return 1;
+		}
+		else{
+			files[num_of_files++] = argv[a];
+		}
+	}
+
+	if(config.iterations < 1){
+		config.iterations = 1;
+	}
+
+	if(config.enc_width < 4 || config.enc_height < 4 || config.enc_frames < 1){
+		config.encode = FALSE;
+	}
+
+	if(config.simd != NULL){
+		AGMV_SetSIMD(GetSIMD(config.simd));
+	}
+
+	fprintf(out,"{\n\t\"tool\": \"agmvbench\",\n\t\"version\": \"1.1\",\n");
+	fprintf(out,"\t\"config\": {\n\t\t\"iterations\": %lu,\n\t\t\"threads\": %lu,\n\t\t\"cores\": %lu,\n\t\t\"simd\": \"%s\"\n\t},\n",config.iterations,config.threads,AGMV_GetNumberOfCores(),GetSIMDName(AGMV_GetSIMD()));
+	fprintf(out,"\t\"decode\": [");
+
+	for(i = 0; i < num_of_files; i++){
+		if(BenchDecode(out,files[i],&config,first) == TRUE){
+			first = FALSE;
+		}
+		else{
+			fprintf(stderr,"agmvbench: could not decode %s\n",files[i]);
+		}
+	}
+
+	fprintf(out,"%s]",first ? "" : "\n\t");
+
+	if(config.encode == TRUE){
+		fprintf(out,",\n");
+		BenchEncode(out,&config);
+	}
+
+	if(config.clip_dir != NULL){
+		BenchClip(out,&config);
+	}
+
+	fprintf(out,"\n}\n");
+
+	if(out != stdout){
+		fclose(out);
+	}
+
+	free(files);
+
+	return 0;
+}
@@ -74,14 +74,7 @@ void AGMV_PlaySound(){
 void Init(){
 	screen = AGMV_CreateScreen(200,200,640,480,AGIDL_RGB_888);
 	
-	agmv = (AGMV*)malloc(sizeof(AGMV));
-
-	agmv->frame_chunk = (AGMV_FRAME_CHUNK*)malloc(sizeof(AGMV_FRAME_CHUNK));
-	agmv->audio_chunk = (AGMV_AUDIO_CHUNK*)malloc(sizeof(AGMV_AUDIO_CHUNK));
-	agmv->bitstream = (AGMV_BITSTREAM*)malloc(sizeof(AGMV_BITSTREAM));
-	agmv->frame = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->iframe = (AGMV_FRAME*)malloc(sizeof(AGMV_FRAME));
-	agmv->audio_track = (AGMV_AUDIO_TRACK*)malloc(sizeof(AGMV_AUDIO_TRACK));
+	agmv = AGMV_AllocDecoder();
 	
 	play = AGIDL_LoadBMP("res/play.bmp");
 	AGIDL_BMPBGR2RGB(play);